@@ -4,6 +4,7 @@
 #include <windows.h>
 #include <iostream>
 #include <sstream>
+#include <cstdio>
 #include "..\..\components\pace_bms\pace_bms_protocol_v25.h"
 
 
@@ -50,9 +51,36 @@ void VeryVerboseLogFunc(std::string message)
 	veryVerbose << message << std::endl;
 }
 
+void LogFunc(PaceBmsProtocolV25::LogLevel level, const char* format, va_list args)
+{
+	char message[512];
+	vsnprintf(message, sizeof(message), format, args);
+	switch (level)
+	{
+	case PaceBmsProtocolV25::LL_Error:
+		ErrorLogFunc(message);
+		break;
+	case PaceBmsProtocolV25::LL_Warning:
+		WarningLogFunc(message);
+		break;
+	case PaceBmsProtocolV25::LL_Info:
+		InfoLogFunc(message);
+		break;
+	case PaceBmsProtocolV25::LL_Debug:
+		DebugLogFunc(message);
+		break;
+	case PaceBmsProtocolV25::LL_Verbose:
+		VerboseLogFunc(message);
+		break;
+	default:
+		VeryVerboseLogFunc(message);
+		break;
+	}
+}
+
 void BasicTests()
 {
-	PaceBmsProtocolV25* paceBms = new PaceBmsProtocolV25(PaceBmsProtocolV25::CID1_LithiumIron, &ErrorLogFunc, &WarningLogFunc, &InfoLogFunc, &DebugLogFunc, &VerboseLogFunc, &VeryVerboseLogFunc);
+	PaceBmsProtocolV25* paceBms = new PaceBmsProtocolV25({}, {}, PaceBmsProtocolV25::CID1_LithiumIron, &LogFunc);
 	std::vector<uint8_t> buffer;
 	bool res;
 
@@ -156,9 +184,9 @@ void BasicTests()
 		analogInfo.fullCapacityMilliampHours != 103460 ||
 		analogInfo.cycleCount != 140 ||
 		analogInfo.designCapacityMilliampHours != 100000 ||
-		analogInfo.SoC != 46.5783882f ||
-		analogInfo.SoH != 100.0f ||
-		analogInfo.powerWatts != -117.965248f ||
+		analogInfo.SoCHundredthsPercent != 4657 ||
+		analogInfo.SoHHundredthsPercent != 10000 ||
+		analogInfo.powerMilliwatts != -117965 ||
 		analogInfo.minCellVoltageMillivolts != 3269 ||
 		analogInfo.maxCellVoltageMillivolts != 3272 ||
 		analogInfo.avgCellVoltageMillivolts != 3270 ||
@@ -3229,7 +3257,7 @@ void ComPortTests(int portNum, int rs485_address)
 	SetCommMask(serialHandle, EV_RXCHAR);
 
 
-	PaceBmsProtocolV25* paceBms = new PaceBmsProtocolV25(PaceBmsProtocolV25::CID1_LithiumIron, &ErrorLogFunc, &WarningLogFunc, &InfoLogFunc, &DebugLogFunc, &VerboseLogFunc, &VeryVerboseLogFunc);
+	PaceBmsProtocolV25* paceBms = new PaceBmsProtocolV25({}, {}, PaceBmsProtocolV25::CID1_LithiumIron, &LogFunc);
 
 	/*
 	ZeroMemory(buffer, bufferLen);
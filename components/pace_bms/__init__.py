@@ -1,13 +1,21 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.cpp_helpers import gpio_pin_expression
-from esphome.components import uart
+from esphome.components import uart, web_server_base
+from esphome.components.logger import LOG_LEVEL_SEVERITY
 from esphome.const import (
     CONF_ID,
+    CONF_LEVEL,
+    CONF_LOGGER,
     CONF_FLOW_CONTROL_PIN,
     CONF_ADDRESS,
+    CONF_UART_ID,
+    CONF_UPDATE_INTERVAL,
+    PLATFORM_ESP32,
+    PLATFORM_ESP8266,
 )
 from esphome import pins
+from esphome.core import CORE
 
 CODEOWNERS = ["@nkinnan"]
 
@@ -15,6 +23,8 @@ DEPENDENCIES = ["uart"]
 
 pace_bms_ns = cg.esphome_ns.namespace("pace_bms")
 PaceBms = pace_bms_ns.class_("PaceBms", cg.PollingComponent, uart.UARTDevice)
+PaceBmsScheduler = pace_bms_ns.class_("PaceBmsScheduler")
+SchedulerPriority = PaceBmsScheduler.enum("Priority")
 
 # "this" for pace_bms_sensor/text_sensor/switch/etc. to get parent from
 CONF_PACE_BMS_ID = "pace_bms_id"
@@ -24,9 +34,31 @@ CONF_PROTOCOL_COMMANDSET         = "protocol_commandset"
 CONF_PROTOCOL_VARIANT            = "protocol_variant"
 CONF_PROTOCOL_VERSION            = "protocol_version"
 CONF_CHEMISTRY                   = "battery_chemistry"
+CONF_PROTOCOL_DETECT             = "protocol_detect"
 
 CONF_REQUEST_THROTTLE            = "request_throttle"
 CONF_RESPONSE_TIMEOUT            = "response_timeout"
+CONF_MAX_RETRIES                 = "max_retries"
+CONF_RETRY_BACKOFF               = "retry_backoff"
+CONF_ANALOG_INFORMATION_INTERVAL = "analog_information_interval"
+CONF_CONFIGURATION_INTERVAL      = "configuration_interval"
+CONF_STALE_TIMEOUT               = "stale_timeout"
+CONF_OFFLINE_TIMEOUTS            = "offline_timeouts"
+CONF_OFFLINE_MAX_INTERVAL        = "offline_max_interval"
+CONF_BAUD_RATE_PROBE             = "baud_rate_probe"
+CONF_LISTEN_ONLY                 = "listen_only"
+
+CONF_SECONDARY_UART              = "secondary_uart"
+CONF_COMMANDS                    = "commands"
+CONF_RX_PATTERN_DETECT           = "rx_pattern_detect"
+
+CONF_PROXY                       = "proxy"
+CONF_CACHE_TTL                   = "cache_ttl"
+
+CONF_FRAME_CAPTURE               = "frame_capture"
+CONF_BUFFER_SIZE                 = "buffer_size"
+CONF_WEB_PATH                    = "web_path"
+CONF_WEB_SERVER_BASE_ID          = "web_server_base_id"
 
 
 #DEFAULT_FLOW_CONTROL_PIN = 
@@ -39,6 +71,51 @@ DEFAULT_PROTOCOL_COMMANDSET = 0x25
 
 DEFAULT_REQUEST_THROTTLE = "50ms"
 DEFAULT_RESPONSE_TIMEOUT = "200ms"
+DEFAULT_MAX_RETRIES = 2
+DEFAULT_RETRY_BACKOFF = "100ms"
+# two requests in a row going unanswered along with all their retries, with the default max_retries
+DEFAULT_OFFLINE_TIMEOUTS = 6
+DEFAULT_OFFLINE_MAX_INTERVAL = "5min"
+
+# writes always stay on the primary so they go out in the order they were made
+SECONDARY_UART_COMMANDS = {
+    "protection": SchedulerPriority.PRIORITY_PROTECTION,
+    "information": SchedulerPriority.PRIORITY_INFORMATION,
+    "configuration": SchedulerPriority.PRIORITY_CONFIGURATION,
+}
+DEFAULT_SECONDARY_UART_COMMANDS = ["information", "configuration"]
+
+DEFAULT_FRAME_CAPTURE_BUFFER_SIZE = 8192
+DEFAULT_FRAME_CAPTURE_WEB_PATH = "/pace_bms/capture.pcap"
+
+
+FRAME_CAPTURE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_BUFFER_SIZE, default=DEFAULT_FRAME_CAPTURE_BUFFER_SIZE): cv.int_range(min=512, max=262144),
+        # only served if web_server (or anything else that brings in web_server_base) is in the config
+        cv.OnlyWith(CONF_WEB_SERVER_BASE_ID, "web_server_base"): cv.use_id(web_server_base.WebServerBase),
+        cv.Optional(CONF_WEB_PATH, default=DEFAULT_FRAME_CAPTURE_WEB_PATH): cv.string_strict,
+    }
+)
+
+
+SECONDARY_UART_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_UART_ID): cv.use_id(uart.UARTComponent),
+        cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
+        cv.Optional(CONF_COMMANDS, default=DEFAULT_SECONDARY_UART_COMMANDS): cv.ensure_list(cv.enum(SECONDARY_UART_COMMANDS, lower=True)),
+    }
+)
+
+
+PROXY_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_UART_ID): cv.use_id(uart.UARTComponent),
+        cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
+        # defaults to twice update_interval, so whatever this hub reads itself is always answered from the cache
+        cv.Optional(CONF_CACHE_TTL): cv.positive_time_period_milliseconds,
+    }
+)
 
 
 CONFIG_SCHEMA = (
@@ -53,18 +130,102 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_PROTOCOL_VARIANT): cv.string_strict,
             cv.Optional(CONF_PROTOCOL_VERSION): cv.int_range(min=0, max=255),
             cv.Optional(CONF_CHEMISTRY): cv.int_range(min=0, max=255),
+            # try the likely protocol_version / battery_chemistry combinations on startup if the configured ones get no answer
+            cv.Optional(CONF_PROTOCOL_DETECT, default=False): cv.boolean,
 
             cv.Optional(CONF_REQUEST_THROTTLE, default=DEFAULT_REQUEST_THROTTLE): cv.positive_time_period_milliseconds,
             cv.Optional(CONF_RESPONSE_TIMEOUT, default=DEFAULT_RESPONSE_TIMEOUT): cv.positive_time_period_milliseconds,
+            # after a timeout or a damaged response the same request is sent again this many times, with the backoff doubling each time
+            cv.Optional(CONF_MAX_RETRIES, default=DEFAULT_MAX_RETRIES): cv.int_range(min=0, max=8),
+            cv.Optional(CONF_RETRY_BACKOFF, default=DEFAULT_RETRY_BACKOFF): cv.positive_time_period_milliseconds,
+            # poll SoC / capacity with the much smaller "read remaining capacity" request every update_interval, and only read the full analog information this often
+            cv.Optional(CONF_ANALOG_INFORMATION_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_CONFIGURATION_INTERVAL): cv.positive_time_period_milliseconds,
+            # analog and status sensors are made unavailable if no good response has been received for this long
+            cv.Optional(CONF_STALE_TIMEOUT): cv.positive_time_period_milliseconds,
+            # after this many timeouts in a row only a single read is sent, less and less often up to offline_max_interval, until the pack answers again
+            cv.Optional(CONF_OFFLINE_TIMEOUTS, default=DEFAULT_OFFLINE_TIMEOUTS): cv.int_range(min=0, max=255),
+            cv.Optional(CONF_OFFLINE_MAX_INTERVAL, default=DEFAULT_OFFLINE_MAX_INTERVAL): cv.positive_time_period_milliseconds,
+            # baud rates to try on startup, the fastest one the BMS answers at is used instead of the uart's baud_rate
+            cv.Optional(CONF_BAUD_RATE_PROBE): cv.All(
+                cv.ensure_list(cv.int_range(min=1200, max=921600)), cv.Length(min=1), cv.only_on([PLATFORM_ESP32, PLATFORM_ESP8266])
+            ),
+            # never send anything, just decode the responses to another master's (e.g. an inverter's) requests on the same bus
+            cv.Optional(CONF_LISTEN_ONLY, default=False): cv.boolean,
+
+            # a second port on the same pack (e.g. RS232 and RS485), so some commands can be sent in parallel
+            cv.Optional(CONF_SECONDARY_UART): SECONDARY_UART_SCHEMA,
+            # a uart other clients can query the pack through, reads are answered from this hub's cached responses
+            cv.Optional(CONF_PROXY): PROXY_SCHEMA,
+            # have the ESP-IDF uart driver flag each EOI so responses are read whole instead of polled for byte by byte
+            cv.Optional(CONF_RX_PATTERN_DETECT): cv.All(cv.boolean, cv.only_with_esp_idf),
+
+            cv.Optional(CONF_FRAME_CAPTURE): FRAME_CAPTURE_SCHEMA,
         }
     )
     .extend(cv.polling_component_schema("60s"))
     .extend(uart.UART_DEVICE_SCHEMA)
 )
 
-FINAL_VALIDATE_SCHEMA = uart.final_validate_device_schema(
-    "pace_bms", baud_rate=9600, require_rx=True, require_tx=True, 
-)
+
+def _validate_v25_only_options(config):
+    if CONF_ANALOG_INFORMATION_INTERVAL in config and config[CONF_PROTOCOL_COMMANDSET] != 0x25:
+        raise cv.Invalid(f"{CONF_ANALOG_INFORMATION_INTERVAL} is only supported with protocol_commandset 0x25")
+    if CONF_CONFIGURATION_INTERVAL in config and config[CONF_PROTOCOL_COMMANDSET] != 0x25:
+        raise cv.Invalid(f"{CONF_CONFIGURATION_INTERVAL} is only supported with protocol_commandset 0x25")
+    return config
+
+
+def _validate_secondary_uart(config):
+    if (secondary_uart_config := config.get(CONF_SECONDARY_UART)) is not None and secondary_uart_config[CONF_UART_ID] == config[CONF_UART_ID]:
+        raise cv.Invalid(f"{CONF_SECONDARY_UART} must use a different uart than {CONF_UART_ID}")
+    return config
+
+
+def _validate_proxy(config):
+    if (proxy_config := config.get(CONF_PROXY)) is None:
+        return config
+    uart_ids = [config[CONF_UART_ID]]
+    if (secondary_uart_config := config.get(CONF_SECONDARY_UART)) is not None:
+        uart_ids.append(secondary_uart_config[CONF_UART_ID])
+    if proxy_config[CONF_UART_ID] in uart_ids:
+        raise cv.Invalid(f"{CONF_PROXY} must use a uart of its own")
+    return config
+
+
+def _validate_stale_timeout(config):
+    if (stale_timeout := config.get(CONF_STALE_TIMEOUT)) is None:
+        return config
+    # anything shorter would mark values unavailable in between perfectly normal refreshes
+    for interval_key in (CONF_UPDATE_INTERVAL, CONF_ANALOG_INFORMATION_INTERVAL):
+        if (interval := config.get(interval_key)) is not None and stale_timeout <= interval:
+            raise cv.Invalid(f"{CONF_STALE_TIMEOUT} must be longer than {interval_key}")
+    return config
+
+
+def _validate_listen_only(config):
+    if not config[CONF_LISTEN_ONLY]:
+        return config
+    # all of these need to send requests of their own, or (pattern detect) expect the only EOI in the buffer to be the response's
+    for key in (CONF_BAUD_RATE_PROBE, CONF_PROTOCOL_DETECT, CONF_SECONDARY_UART, CONF_RX_PATTERN_DETECT, CONF_PROXY):
+        if config.get(key):
+            raise cv.Invalid(f"{key} can't be used with {CONF_LISTEN_ONLY}")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(CONFIG_SCHEMA, _validate_v25_only_options, _validate_secondary_uart, _validate_stale_timeout, _validate_listen_only, _validate_proxy)
+
+def FINAL_VALIDATE_SCHEMA(config):
+    # a listen only hub never transmits so it can share the bus on an rx-only pin
+    return uart.final_validate_device_schema(
+        "pace_bms", require_rx=True, require_tx=not config[CONF_LISTEN_ONLY], 
+    )(config)
+
+def _protocol_log_level():
+    # the protocol library's LogLevel values are numbered the same as these, and without a logger nothing is logged at all
+    if (logger_config := CORE.config.get(CONF_LOGGER)) is None:
+        return 0
+    return LOG_LEVEL_SEVERITY.index(logger_config[CONF_LEVEL])
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
@@ -72,6 +233,9 @@ async def to_code(config):
 
     await uart.register_uart_device(var, config)
 
+    # the protocol library has no esphome dependencies, so rather than it reading ESPHOME_LOG_LEVEL it's told what to compile out
+    cg.add_build_flag(f"-DPACE_BMS_LOG_LEVEL={_protocol_log_level()}")
+
     if CONF_FLOW_CONTROL_PIN in config:
         pin = await gpio_pin_expression(config[CONF_FLOW_CONTROL_PIN])
         cg.add(var.set_flow_control_pin(pin))
@@ -85,8 +249,47 @@ async def to_code(config):
         cg.add(var.set_protocol_version(config[CONF_PROTOCOL_VERSION]))
     if CONF_CHEMISTRY in config:
         cg.add(var.set_chemistry(config[CONF_CHEMISTRY]))
+    if config[CONF_PROTOCOL_DETECT]:
+        cg.add(var.set_protocol_detect(True))
     if CONF_REQUEST_THROTTLE in config:
         cg.add(var.set_request_throttle(config[CONF_REQUEST_THROTTLE]))
     if CONF_RESPONSE_TIMEOUT in config:
         cg.add(var.set_response_timeout(config[CONF_RESPONSE_TIMEOUT]))
-
+    cg.add(var.set_max_retries(config[CONF_MAX_RETRIES]))
+    cg.add(var.set_retry_backoff(config[CONF_RETRY_BACKOFF]))
+    if CONF_ANALOG_INFORMATION_INTERVAL in config:
+        cg.add(var.set_analog_information_interval(config[CONF_ANALOG_INFORMATION_INTERVAL]))
+    if CONF_CONFIGURATION_INTERVAL in config:
+        cg.add(var.set_configuration_interval(config[CONF_CONFIGURATION_INTERVAL]))
+    if CONF_STALE_TIMEOUT in config:
+        cg.add(var.set_stale_timeout(config[CONF_STALE_TIMEOUT]))
+    cg.add(var.set_offline_timeouts(config[CONF_OFFLINE_TIMEOUTS]))
+    cg.add(var.set_offline_max_interval(config[CONF_OFFLINE_MAX_INTERVAL]))
+    if config[CONF_LISTEN_ONLY]:
+        cg.add(var.set_listen_only(True))
+    for baud_rate in sorted(set(config.get(CONF_BAUD_RATE_PROBE, [])), reverse=True):
+        cg.add(var.add_baud_rate_probe(baud_rate))
+    if secondary_uart_config := config.get(CONF_SECONDARY_UART):
+        secondary_uart = await cg.get_variable(secondary_uart_config[CONF_UART_ID])
+        cg.add(var.set_secondary_uart(secondary_uart))
+        if CONF_FLOW_CONTROL_PIN in secondary_uart_config:
+            pin = await gpio_pin_expression(secondary_uart_config[CONF_FLOW_CONTROL_PIN])
+            cg.add(var.set_secondary_flow_control_pin(pin))
+        for priority in secondary_uart_config[CONF_COMMANDS]:
+            cg.add(var.add_secondary_uart_priority(priority))
+    if proxy_config := config.get(CONF_PROXY):
+        proxy_uart = await cg.get_variable(proxy_config[CONF_UART_ID])
+        cg.add(var.set_proxy_uart(proxy_uart))
+        if CONF_FLOW_CONTROL_PIN in proxy_config:
+            pin = await gpio_pin_expression(proxy_config[CONF_FLOW_CONTROL_PIN])
+            cg.add(var.set_proxy_flow_control_pin(pin))
+        if CONF_CACHE_TTL in proxy_config:
+            cg.add(var.set_proxy_cache_ttl(proxy_config[CONF_CACHE_TTL]))
+    if config.get(CONF_RX_PATTERN_DETECT):
+        cg.add(var.set_rx_pattern_detect(True))
+    if frame_capture_config := config.get(CONF_FRAME_CAPTURE):
+        cg.add(var.set_frame_capture_size(frame_capture_config[CONF_BUFFER_SIZE]))
+        if CONF_WEB_SERVER_BASE_ID in frame_capture_config:
+            web_server = await cg.get_variable(frame_capture_config[CONF_WEB_SERVER_BASE_ID])
+            cg.add_define("USE_PACE_BMS_FRAME_CAPTURE_WEB")
+            cg.add(var.set_frame_capture_web_server(web_server, frame_capture_config[CONF_WEB_PATH]))
@@ -26,11 +26,19 @@ void PaceBmsButton::setup() {
 	else {
 		ESP_LOGE(TAG, "Protocol version not supported: 0x%02X", this->parent_->get_protocol_commandset());
 	}
+
+	if (this->scan_addresses_button_ != nullptr) {
+		this->scan_addresses_button_->add_on_press_callback([this]() {
+			ESP_LOGD(TAG, "Starting address scan");
+			this->parent_->start_address_scan();
+		});
+	}
 }
 
 void PaceBmsButton::dump_config() {
 	ESP_LOGCONFIG(TAG, "pace_bms_button:");
 	LOG_BUTTON("  ", "Shutdown", this->shutdown_button_);
+	LOG_BUTTON("  ", "Scan Addresses", this->scan_addresses_button_);
 }
 
 }  // namespace pace_bms
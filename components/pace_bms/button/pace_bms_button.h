@@ -13,6 +13,7 @@ public:
 	void set_parent(PaceBms* parent) { parent_ = parent; }
 
 	void set_shutdown_button(button::Button* button) { this->shutdown_button_ = button; }
+	void set_scan_addresses_button(button::Button* button) { this->scan_addresses_button_ = button; }
 
 	void setup() override;
 	float get_setup_priority() const { return setup_priority::DATA; }
@@ -23,6 +24,9 @@ protected:
 
 	// analog info
 	button::Button* shutdown_button_{ nullptr };
+
+	// not tied to a protocol version
+	button::Button* scan_addresses_button_{ nullptr };
 };
 
 }  // namespace pace_bms
@@ -84,6 +84,8 @@ public:
 	void set_environment_over_temperature_protection_number(PaceBmsNumberImplementation* number) { this->environment_over_temperature_protection_number_ = number; }
 	void set_environment_over_temperature_protection_release_number(PaceBmsNumberImplementation* number) { this->environment_over_temperature_protection_release_number_ = number; }
 
+	void set_charge_current_limiter_start_current_number(PaceBmsNumberImplementation* number) { this->charge_current_limiter_start_current_number_ = number; }
+
 
 	void setup() override;
 	float get_setup_priority() const { return setup_priority::DATA; }
@@ -189,6 +191,8 @@ protected:
 	pace_bms::PaceBmsNumberImplementation* environment_over_temperature_alarm_number_{ nullptr };
 	pace_bms::PaceBmsNumberImplementation* environment_over_temperature_protection_number_{ nullptr };
 	pace_bms::PaceBmsNumberImplementation* environment_over_temperature_protection_release_number_{ nullptr };
+
+	pace_bms::PaceBmsNumberImplementation* charge_current_limiter_start_current_number_{ nullptr };
 };
 
 }  // namespace pace_bms
@@ -1,11 +1,20 @@
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <functional>
 
 #include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
 #include "pace_bms_component.h"
 
+#ifdef USE_ESP_IDF
+#include <driver/uart.h>
+#include "esphome/components/uart/uart_component_esp_idf.h"
+#endif
+
 namespace esphome {
 namespace pace_bms {
 
@@ -14,29 +23,16 @@ static const char* const TAG = "pace_bms";
 // for the protocol implementation dependency injection only
 static const char* const TAG_PROTOCOL = "pace_bms_protocol";
 
+uint64_t PaceBms::node_busy_time_ = 0;
+uint8_t PaceBms::node_link_count_ = 0;
+
 /*
 * dependency injection to the protocol implementation
 */
 
-void error_log_func(std::string message) {
-	ESP_LOGE(TAG_PROTOCOL, "%s", message.c_str());
-}
-void warning_log_func(std::string message) {
-	ESP_LOGW(TAG_PROTOCOL, "%s", message.c_str());
-}
-void info_log_func(std::string message) {
-	ESP_LOGI(TAG_PROTOCOL, "%s", message.c_str());
-}
-void debug_log_func(std::string message) {
-	ESP_LOGD(TAG_PROTOCOL, "%s", message.c_str());
-}
-void verbose_log_func(std::string message) {
-	ESP_LOGV(TAG_PROTOCOL, "%s", message.c_str());
-}
-void very_verbose_log_func(std::string message) {
-#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
-	ESP_LOGVV(TAG_PROTOCOL, "%s", message.c_str());
-#endif
+void protocol_log_func(PaceBmsProtocolBase::LogLevel level, const char* format, va_list args) {
+	// the protocol levels are numbered the same as esphome's, and anything below the compile-time level never gets here
+	esp_log_vprintf_(level, TAG_PROTOCOL, __LINE__, format, args);
 }
 
 /*
@@ -45,12 +41,61 @@ void very_verbose_log_func(std::string message) {
 
 void PaceBms::dump_config() {
 	ESP_LOGCONFIG(TAG, "pace_bms:");
-	LOG_PIN("  Flow Control Pin: ", this->flow_control_pin_);
+	LOG_PIN("  Flow Control Pin: ", this->primary_link_.flow_control_pin_);
+	if (this->secondary_link_ != nullptr) {
+		ESP_LOGCONFIG(TAG, "  Secondary UART carries:");
+		for (uint8_t priority = 0; priority < PaceBmsScheduler::PRIORITY_COUNT; priority++) {
+			if ((this->secondary_link_->priorities_ & PaceBmsScheduler::priority_mask((PaceBmsScheduler::Priority) priority)) != 0)
+				ESP_LOGCONFIG(TAG, "    %s", PaceBmsScheduler::get_priority_name((PaceBmsScheduler::Priority) priority));
+		}
+		LOG_PIN("  Secondary Flow Control Pin: ", this->secondary_link_->flow_control_pin_);
+	}
+#ifdef USE_ESP_IDF
+	if (this->rx_pattern_detect_)
+		ESP_LOGCONFIG(TAG, "  RX Pattern Detect: %s", this->primary_link_.pattern_detect_uart_num_ >= 0 ? "YES" : "FAILED");
+#endif
+	if (this->listen_only_)
+		ESP_LOGCONFIG(TAG, "  Listen Only: YES");
+	if (this->proxy_link_ != nullptr) {
+		ESP_LOGCONFIG(TAG, "  Proxy Cache TTL (ms): %u", (unsigned) (this->proxy_cache_ttl_ != 0 ? this->proxy_cache_ttl_ : 2 * this->get_update_interval()));
+		LOG_PIN("  Proxy Flow Control Pin: ", this->proxy_link_->flow_control_pin_);
+	}
 	ESP_LOGCONFIG(TAG, "  Address: %i", this->address_);
 	ESP_LOGCONFIG(TAG, "  Protocol Version: 0x%02X", this->protocol_commandset_);
+	if (this->protocol_detect_)
+		ESP_LOGCONFIG(TAG, "  Protocol Detect: YES");
 	ESP_LOGCONFIG(TAG, "  Request Throttle (ms): %i", this->request_throttle_);
 	ESP_LOGCONFIG(TAG, "  Response Timeout (ms): %i", this->response_timeout_);
-	this->check_uart_settings(9600);
+	ESP_LOGCONFIG(TAG, "  Max Retries: %u", this->max_retries_);
+	if (this->max_retries_ != 0)
+		ESP_LOGCONFIG(TAG, "  Retry Backoff (ms): %u", (unsigned) this->retry_backoff_);
+	if (this->analog_information_interval_ != 0)
+		ESP_LOGCONFIG(TAG, "  Analog Information Interval (ms): %u", (unsigned) this->analog_information_interval_);
+	if (this->configuration_interval_ != 0)
+		ESP_LOGCONFIG(TAG, "  Configuration Interval (ms): %u", (unsigned) this->configuration_interval_);
+	if (this->stale_timeout_ != 0)
+		ESP_LOGCONFIG(TAG, "  Stale Timeout (ms): %u", (unsigned) this->stale_timeout_);
+	if (this->offline_timeouts_ != 0) {
+		ESP_LOGCONFIG(TAG, "  Offline After Timeouts: %u", this->offline_timeouts_);
+		ESP_LOGCONFIG(TAG, "  Offline Max Interval (ms): %u", (unsigned) this->offline_max_interval_);
+	}
+	if (this->frame_capture_ != nullptr) {
+		ESP_LOGCONFIG(TAG, "  Frame Capture Buffer (bytes): %u", (unsigned) this->frame_capture_->get_capacity());
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+		ESP_LOGCONFIG(TAG, "  Frame Capture Web Path: %s", this->frame_capture_web_path_.c_str());
+#endif
+	}
+	if (!this->baud_rate_probe_.empty()) {
+		ESP_LOGCONFIG(TAG, "  Baud Rate Probe:");
+		for (uint32_t baud_rate : this->baud_rate_probe_)
+			ESP_LOGCONFIG(TAG, "    %u", (unsigned) baud_rate);
+	}
+	// any baud rate the pack supports, but always 8N1
+	this->check_uart_settings(this->parent_->get_baud_rate());
+	if (this->secondary_link_ != nullptr)
+		this->secondary_link_->uart_->check_uart_settings(this->secondary_link_->component_->get_baud_rate());
+	if (this->proxy_link_ != nullptr)
+		this->proxy_link_->uart_->check_uart_settings(this->proxy_link_->component_->get_baud_rate());
 }
 
 /*
@@ -58,36 +103,100 @@ void PaceBms::dump_config() {
 */
 
 void PaceBms::setup() {
-	if (this->protocol_commandset_ == 0x25) {
-		// the protocol en/decoder PaceBmsProtocolV25 is meant to be standalone with no dependencies, so inject esphome logging function wrappers on construction
-		this->pace_bms_v25_ = new PaceBmsProtocolV25(
-			protocol_variant_, protocol_version_, chemistry_,
-			error_log_func, warning_log_func, info_log_func, debug_log_func, verbose_log_func, very_verbose_log_func);
-	}
-	else if (this->protocol_commandset_ == 0x20) {
-		// the protocol en/decoder PaceBmsProtocolV25 is meant to be standalone with no dependencies, so inject esphome logging function wrappers on construction
-		this->pace_bms_v20_ = new PaceBmsProtocolV20(
-			protocol_variant_, protocol_version_, chemistry_,
-			error_log_func, warning_log_func, info_log_func, debug_log_func, verbose_log_func, very_verbose_log_func);
-	}
-	else {
+	if (this->protocol_commandset_ != 0x25 &&
+		this->protocol_commandset_ != 0x20) {
 		this->status_set_error();
 		ESP_LOGE(TAG, "Protocol version 0x%02X is not supported", this->protocol_commandset_);
 		return;
 	}
+	this->create_protocol_();
+
+	if (this->primary_link_.flow_control_pin_ != nullptr)
+		this->primary_link_.flow_control_pin_->setup();
+	node_link_count_ += this->get_link_count();
+	if (this->secondary_link_ != nullptr) {
+		if (this->secondary_link_->flow_control_pin_ != nullptr)
+			this->secondary_link_->flow_control_pin_->setup();
+		// whatever isn't explicitly moved to the secondary stays on the primary, including writes so they stay in order
+		this->primary_link_.priorities_ = PaceBmsScheduler::ALL_PRIORITIES & ~this->secondary_link_->priorities_;
+	}
+	if (this->proxy_link_ != nullptr && this->proxy_link_->flow_control_pin_ != nullptr)
+		this->proxy_link_->flow_control_pin_->setup();
+	if (!this->baud_rate_probe_.empty()) {
+		this->configured_baud_rate_ = this->parent_->get_baud_rate();
+		this->baud_rate_probe_index_ = 0;
+	}
+	if (this->protocol_detect_)
+		this->start_protocol_detect_();
+#ifdef USE_ESP_IDF
+	if (this->rx_pattern_detect_) {
+		// reconfiguring the uart can reset the driver, so on the primary this waits for the baud rate probe to finish
+		if (this->baud_rate_probe_index_ < 0)
+			this->enable_pattern_detect_(this->primary_link_, this->parent_);
+		if (this->secondary_link_ != nullptr)
+			this->enable_pattern_detect_(*this->secondary_link_, this->secondary_link_->component_);
+	}
+#endif
 
-	if (this->flow_control_pin_ != nullptr)
-		this->flow_control_pin_->setup();
+	if (this->frame_capture_size_ > 0) {
+		this->frame_capture_ = new PaceBmsFrameCapture();
+		this->frame_capture_->allocate(this->frame_capture_size_);
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+		if (this->frame_capture_web_server_ != nullptr) {
+			this->frame_capture_web_server_->init();
+			this->frame_capture_web_server_->add_handler(new PaceBmsFrameCaptureHandler(this->frame_capture_, this->frame_capture_web_path_));
+		}
+#endif
+	}
 
-	// clear uart buffer
+	// clear uart buffers
 	uint8_t byte;
 	while (this->available() != 0) {
 		this->read_byte(&byte);
 	}
+	if (this->secondary_link_ != nullptr) {
+		while (this->secondary_link_->uart_->available() != 0) {
+			this->secondary_link_->uart_->read_byte(&byte);
+		}
+	}
+	if (this->proxy_link_ != nullptr) {
+		while (this->proxy_link_->uart_->available() != 0) {
+			this->proxy_link_->uart_->read_byte(&byte);
+		}
+	}
+}
+
+void PaceBms::create_protocol_() {
+	delete this->pace_bms_v25_;
+	delete this->pace_bms_v20_;
+	this->pace_bms_v25_ = nullptr;
+	this->pace_bms_v20_ = nullptr;
+	if (this->protocol_commandset_ == 0x25) {
+		// the protocol en/decoder PaceBmsProtocolV25 is meant to be standalone with no dependencies, so inject an esphome logging function wrapper on construction
+		this->pace_bms_v25_ = new PaceBmsProtocolV25(
+			protocol_variant_, protocol_version_, chemistry_,
+			protocol_log_func);
+	}
+	else if (this->protocol_commandset_ == 0x20) {
+		// the protocol en/decoder PaceBmsProtocolV25 is meant to be standalone with no dependencies, so inject an esphome logging function wrapper on construction
+		this->pace_bms_v20_ = new PaceBmsProtocolV20(
+			protocol_variant_, protocol_version_, chemistry_,
+			protocol_log_func);
+	}
+}
+
+void PaceBms::set_secondary_uart(uart::UARTComponent* secondary_uart) {
+	this->secondary_link_ = new link{ "secondary", new uart::UARTDevice(secondary_uart), secondary_uart };
+	this->secondary_link_->priorities_ = 0;
+}
+
+void PaceBms::set_proxy_uart(uart::UARTComponent* proxy_uart) {
+	this->proxy_link_ = new link{ "proxy", new uart::UARTDevice(proxy_uart), proxy_uart };
+	this->proxy_link_->priorities_ = 0;
 }
 
 /*
-* fill read_queue_ with any necessary BMS commands to update sensor values, based on what was subscribed for by child sensor
+* queue any necessary BMS commands to update sensor values, based on what was subscribed for by child sensor
 * instances via setting callbacks to receive the updates
 */
 
@@ -96,209 +205,365 @@ void PaceBms::update() {
 		this->pace_bms_v20_ == nullptr)
 		return;
 
-	// writes are always processed first so no need to check that as well
-	if (!read_queue_.empty()) {
-		ESP_LOGW(TAG, "Commands still in queue on update(), skipping this refresh cycle: Could not speak with the BMS fast enough: increase update_interval or reduce request_throttle.");
-	}
-	else {
-		if (this->pace_bms_v25_ != nullptr) {
-			ESP_LOGV(TAG, "Queueing v25 refresh commands");
-
-			if (this->analog_information_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read analog information");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadAnalogInformationRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_analog_information_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->status_information_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read status information");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadStatusInformationRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_status_information_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->hardware_version_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read hardware version");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->serial_number_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read serial number");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadSerialNumberRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_serial_number_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->protocols_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read protocols");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadProtocolsRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_protocols_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->cell_over_voltage_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read cell over voltage configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellOverVoltage, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_over_voltage_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->pack_over_voltage_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read pack over voltage configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_PackOverVoltage, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_pack_over_voltage_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->cell_under_voltage_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read cell under voltage configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellUnderVoltage, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_under_voltage_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->pack_under_voltage_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read pack under voltage configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_PackUnderVoltage, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_pack_under_voltage_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->charge_over_current_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read charge over current configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeOverCurrent, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_over_current_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->discharge_over_current1_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read discharge over current 1 configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_DischargeOverCurrent1, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_discharge_over_current1_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->discharge_over_current2_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read discharge over current 2 configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_DischargeOverCurrent2, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_discharge_over_current2_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->short_circuit_protection_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read short circuit protection configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ShortCircuitProtection, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_short_circuit_protection_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->cell_balancing_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read cell balancing configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellBalancing, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_balancing_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->sleep_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read sleep configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_Sleep, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_sleep_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->full_charge_low_charge_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read full charge low charge configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_FullChargeLowCharge, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_full_charge_low_charge_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->charge_and_discharge_over_temperature_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read charge and discharge over temperature configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeAndDischargeOverTemperature, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_and_discharge_over_temperature_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->charge_and_discharge_under_temperature_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read charge and discharge under temperature configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeAndDischargeUnderTemperature, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_and_discharge_under_temperature_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->system_datetime_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read system date/time");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadSystemDateTimeRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_system_datetime_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->mosfet_over_temperature_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read mosfet over temperature configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_MosfetOverTemperature, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_mosfet_over_temperature_configuration_response_v25(response); };
-				read_queue_.push(item);
-			}
-			if (this->environment_over_under_temperature_configuration_callbacks_v25_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read environment over/under temperature configuration");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_EnvironmentOverUnderTemperature, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_environment_over_under_temperature_configuration_response_v25(response); };
-				read_queue_.push(item);
+	// nothing would go out at the right baud rate (or protocol version) yet, the probes call this themselves once they're 
+	//     done, as does an address scan
+	if (this->baud_rate_probe_index_ >= 0 ||
+		this->protocol_detect_index_ >= 0 ||
+		this->address_scan_address_ >= 0)
+		return;
+
+	// dispatch the scheduler statistics before anything new is queued
+	for (int i = 0; i < this->scheduler_callbacks_.size(); i++) {
+		scheduler_callbacks_[i](this->scheduler_);
+	}
+	if (this->data_age_callbacks_.size() > 0) {
+		for (uint8_t group = 0; group < DATA_GROUP_COUNT; group++) {
+			auto age = this->get_data_age((DataGroup) group);
+			if (!age.has_value())
+				continue;
+			for (int i = 0; i < this->data_age_callbacks_.size(); i++) {
+				data_age_callbacks_[i]((DataGroup) group, *age);
 			}
 		}
-		else if (this->pace_bms_v20_ != nullptr) {
-			ESP_LOGV(TAG, "Queueing v20 refresh commands");
-
-			if (this->analog_information_callbacks_v20_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read analog information");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadAnalogInformationRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_analog_information_response_v20(response); };
-				read_queue_.push(item);
-			}
-			if (this->status_information_callbacks_v20_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read status information");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadStatusInformationRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_status_information_response_v20(response); };
-				read_queue_.push(item);
-			}
-			if (this->hardware_version_callbacks_v20_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read hardware version");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v20(response); };
-				read_queue_.push(item);
-			}
-			if (this->serial_number_callbacks_v20_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read serial number");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadSerialNumberRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_serial_number_response_v20(response); };
-				read_queue_.push(item);
-			}
-			if (this->system_datetime_callbacks_v20_.size() > 0) {
-				command_item* item = new command_item;
-				item->description_ = std::string("read system date/time");
-				item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadSystemDateTimeRequest(this->address_, request); };
-				item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_system_datetime_response_v20(response); };
-				read_queue_.push(item);
-			}
+	}
+
+	// only the one read goes out until the pack answers again
+	if (this->offline_) {
+		this->queue_offline_probe_(millis());
+		return;
+	}
+
+	// anything still queued from an earlier update() keeps its place in line (and its deadline, so it only gets more urgent) 
+	//     rather than being queued again, a slow bus means each value is refreshed a bit later rather than some never at all
+	size_t still_queued = this->scheduler_.get_read_count();
+	if (still_queued != 0) {
+		ESP_LOGD(TAG, "%u read commands still queued on update(), if this keeps happening increase update_interval or reduce request_throttle", (unsigned) still_queued);
+	}
+
+	if (this->pace_bms_v25_ != nullptr) {
+		ESP_LOGV(TAG, "Queueing v25 refresh commands");
+
+		// with analog_information_interval set, the full analog information is only read that often and the much smaller 
+		//     remaining capacity response keeps SoC fresh on every other update
+		bool analog_information_due = this->is_due_(this->analog_information_interval_, this->last_analog_information_queued_, this->analog_information_queued_);
+		if (this->analog_information_callbacks_v25_.size() > 0 && analog_information_due) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read analog information");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadAnalogInformationRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_analog_information_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_PROTECTION);
+			this->last_analog_information_queued_ = millis();
+			this->analog_information_queued_ = true;
+		}
+		else if (this->remaining_capacity_callbacks_v25_.size() > 0 && !analog_information_due) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read remaining capacity");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadRemainingCapacityRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_remaining_capacity_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_PROTECTION);
+		}
+		if (this->status_information_callbacks_v25_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read status information");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadStatusInformationRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_status_information_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_PROTECTION);
+		}
+		if (this->hardware_version_callbacks_v25_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read hardware version");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+		if (this->serial_number_callbacks_v25_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read serial number");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadSerialNumberRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_serial_number_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+		if (this->system_datetime_callbacks_v25_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read system date/time");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadSystemDateTimeRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_system_datetime_response_v25(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+
+		// configuration rarely changes so with configuration_interval set it's only read that often rather than every update
+		if (this->is_due_(this->configuration_interval_, this->last_configuration_queued_, this->configuration_queued_)) {
+			this->queue_configuration_reads_v25_();
+			this->last_configuration_queued_ = millis();
+			this->configuration_queued_ = true;
+		}
+	}
+	else if (this->pace_bms_v20_ != nullptr) {
+		ESP_LOGV(TAG, "Queueing v20 refresh commands");
+
+		if (this->analog_information_callbacks_v20_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read analog information");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadAnalogInformationRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_analog_information_response_v20(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_PROTECTION);
 		}
+		if (this->status_information_callbacks_v20_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read status information");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadStatusInformationRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_status_information_response_v20(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_PROTECTION);
+		}
+		if (this->hardware_version_callbacks_v20_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read hardware version");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v20(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+		if (this->serial_number_callbacks_v20_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read serial number");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadSerialNumberRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_serial_number_response_v20(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+		if (this->system_datetime_callbacks_v20_.size() > 0) {
+			command_item* item = new command_item;
+			item->description_ = std::string("read system date/time");
+			item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadSystemDateTimeRequest(this->address_, request); };
+			item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_system_datetime_response_v20(response); };
+			this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
+		}
+	}
+
+	ESP_LOGV(TAG, "Read commands queued: %i", this->scheduler_.get_read_count());
+}
 
-		ESP_LOGV(TAG, "Read commands queued: %i", read_queue_.size());
+// reads are due again in a refresh period, so that's their deadline, and a read that's already waiting isn't queued twice
+void PaceBms::queue_read_(command_item* item, PaceBmsScheduler::Priority priority) {
+	if (this->listen_only_) {
+		this->listen_for_read_(item);
+		return;
+	}
+	uint32_t relative_deadline = this->get_update_interval();
+	if (priority == PaceBmsScheduler::PRIORITY_CONFIGURATION && this->configuration_interval_ > relative_deadline)
+		relative_deadline = this->configuration_interval_;
+	if (this->is_read_pending_(item->description_)) {
+		ESP_LOGV(TAG, "'%s' is still pending from a previous update", item->description_.c_str());
+		delete item;
+		return;
+	}
+	item->request_frame_ = this->get_read_request_frame_(item);
+	this->scheduler_.push(item, priority, millis(), relative_deadline);
+}
+
+// a read popped from the scheduler is no longer in it, but a second copy would still only fetch the same values again
+bool PaceBms::is_read_pending_(const std::string& description) {
+	if (this->scheduler_.contains(description))
+		return true;
+	for (link* link : { &this->primary_link_, this->secondary_link_ }) {
+		if (link == nullptr)
+			continue;
+		if (link->request_outstanding_ && link->command_ != nullptr && link->command_->description_ == description)
+			return true;
+		if (link->retry_command_ != nullptr && link->retry_command_->description_ == description)
+			return true;
+	}
+	return false;
+}
+
+// null if the frame can't be created, send_request_frame_ will try again (and log it) when the item comes up
+const std::vector<uint8_t>* PaceBms::get_read_request_frame_(command_item* item) {
+	for (const read_request_frame& frame : this->read_request_frames_) {
+		if (frame.description_ == item->description_)
+			return &frame.frame_;
+	}
+	std::vector<uint8_t> request;
+	if (!item->create_request_frame_(request))
+		return nullptr;
+	this->read_request_frames_.push_back({ item->description_, std::move(request) });
+	return &this->read_request_frames_.back().frame_;
+}
+
+// an interval of zero means every update, otherwise true once interval has passed since it was last queued
+//     half an update_interval of slack so an interval that's a multiple of update_interval isn't pushed back a whole cycle by jitter
+bool PaceBms::is_due_(uint32_t interval, uint32_t last_queued, bool queued) {
+	return interval == 0 || !queued || millis() - last_queued + this->get_update_interval() / 2 >= interval;
+}
+
+void PaceBms::mark_received_(DataGroup group) {
+	this->last_received_[group] = millis();
+	this->received_[group] = true;
+	if (this->stale_[group]) {
+		ESP_LOGI(TAG, "Receiving %s again", get_data_group_name(group));
+		this->stale_[group] = false;
+	}
+}
+
+OPTIONAL_NS::optional<uint32_t> PaceBms::get_data_age(DataGroup group) {
+	if (!this->received_[group])
+		return {};
+	return millis() - this->last_received_[group];
+}
+
+// configuration is refreshed on its own (much slower) schedule and only ever changes when we write it, so it isn't
+//     expected to go stale, only the measurements are
+void PaceBms::check_stale_() {
+	if (this->stale_timeout_ == 0)
+		return;
+	const uint32_t now = millis();
+	for (DataGroup group : { DATA_GROUP_ANALOG_INFORMATION, DATA_GROUP_STATUS_INFORMATION }) {
+		if (!this->received_[group] || this->stale_[group] || now - this->last_received_[group] < this->stale_timeout_)
+			continue;
+		ESP_LOGW(TAG, "No %s received for %u ms, marking it unavailable", get_data_group_name(group), (unsigned) (now - this->last_received_[group]));
+		this->mark_stale_(group);
+	}
+}
+
+void PaceBms::mark_stale_(DataGroup group) {
+	this->stale_[group] = true;
+	for (int i = 0; i < this->stale_callbacks_.size(); i++) {
+		stale_callbacks_[i](group);
+	}
+}
+
+const char* PaceBms::get_data_group_name(DataGroup group) {
+	switch (group) {
+	case DATA_GROUP_ANALOG_INFORMATION:
+		return "analog information";
+	case DATA_GROUP_STATUS_INFORMATION:
+		return "status information";
+	case DATA_GROUP_CONFIGURATION:
+		return "configuration";
+	default:
+		return "unknown";
+	}
+}
+
+// every read here is one of the "slow" tier that's gated by configuration_interval_
+void PaceBms::queue_configuration_reads_v25_() {
+	if (this->protocols_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read protocols");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadProtocolsRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_protocols_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->cell_over_voltage_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read cell over voltage configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellOverVoltage, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_over_voltage_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->pack_over_voltage_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read pack over voltage configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_PackOverVoltage, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_pack_over_voltage_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->cell_under_voltage_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read cell under voltage configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellUnderVoltage, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_under_voltage_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->pack_under_voltage_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read pack under voltage configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_PackUnderVoltage, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_pack_under_voltage_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->charge_over_current_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read charge over current configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeOverCurrent, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_over_current_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->discharge_over_current1_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read discharge over current 1 configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_DischargeOverCurrent1, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_discharge_over_current1_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->discharge_over_current2_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read discharge over current 2 configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_DischargeOverCurrent2, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_discharge_over_current2_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->short_circuit_protection_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read short circuit protection configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ShortCircuitProtection, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_short_circuit_protection_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->cell_balancing_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read cell balancing configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_CellBalancing, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_cell_balancing_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->sleep_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read sleep configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_Sleep, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_sleep_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->full_charge_low_charge_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read full charge low charge configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_FullChargeLowCharge, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_full_charge_low_charge_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->charge_and_discharge_over_temperature_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read charge and discharge over temperature configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeAndDischargeOverTemperature, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_and_discharge_over_temperature_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->charge_and_discharge_under_temperature_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read charge and discharge under temperature configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_ChargeAndDischargeUnderTemperature, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_and_discharge_under_temperature_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->mosfet_over_temperature_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read mosfet over temperature configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_MosfetOverTemperature, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_mosfet_over_temperature_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->environment_over_under_temperature_configuration_callbacks_v25_.size() > 0) {
+		command_item* item = new command_item;
+		item->description_ = std::string("read environment over/under temperature configuration");
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadConfigurationRequest(this->address_, PaceBmsProtocolV25::RC_EnvironmentOverUnderTemperature, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_environment_over_under_temperature_configuration_response_v25(response); };
+		this->queue_read_(item, PaceBmsScheduler::PRIORITY_CONFIGURATION);
+	}
+	if (this->charge_current_limiter_start_current_callbacks_v25_.size() > 0) {
+		this->queue_read_(this->create_read_charge_current_limiter_start_current_item_v25_(), PaceBmsScheduler::PRIORITY_CONFIGURATION);
 	}
 }
 
 /*
 * incrementally process incoming bytes off the bus, eventually dispatching a full response to process_response_frame_
-* once request_throttle has been satisfied and no request is outstanding, call send_next_request_frame to continue popping the read/write queues
+* once request_throttle has been satisfied and no request is outstanding on a link, send it the next command from the scheduler
 */
 
 void PaceBms::loop() {
@@ -306,6 +571,9 @@ void PaceBms::loop() {
 		this->pace_bms_v20_ == nullptr)
 		return;
 
+	// before publishing anything, so values that have just gone stale are made unavailable promptly
+	this->check_stale_();
+
 	// update a single sensor per loop, this is still 60 updates/second but prevents excessive loop times
 	if (this->sensor_update_queue_.size() != 0)
 	{
@@ -313,146 +581,965 @@ void PaceBms::loop() {
 		this->sensor_update_queue_.pop();
 		sensor_update_method();
 	}
-	// don't continue while sensor publishes are pending
-	if (this->sensor_update_queue_.size() != 0)
+	// don't send anything new while sensor publishes are pending, but keep receiving whatever is already in flight
+	//     so a slow drain here doesn't hold up another link (or overflow its rx buffer)
+	bool may_send = this->sensor_update_queue_.size() == 0;
+
+	const uint32_t now = millis();
+
+	if (this->baud_rate_probe_index_ >= 0) {
+		this->loop_baud_rate_probe_(now);
+		return;
+	}
+	if (this->protocol_detect_index_ >= 0) {
+		this->loop_protocol_detect_(now);
 		return;
+	}
+	if (this->listen_only_) {
+		this->loop_listen_(now);
+		return;
+	}
+
+	if (this->address_scan_address_ >= 0) {
+		// the scan only takes over the primary link, the others carry on as usual
+		this->loop_address_scan_(now);
+	}
+	else {
+		// the pack has just answered again after being offline, the full read set goes out now rather than next update
+		if (this->resume_polling_) {
+			this->resume_polling_ = false;
+			this->analog_information_queued_ = false;
+			this->configuration_queued_ = false;
+			this->update();
+		}
+
+		this->loop_link_(this->primary_link_, now, may_send);
+	}
+	// each link has its own request outstanding so they run side by side
+	if (this->secondary_link_ != nullptr)
+		this->loop_link_(*this->secondary_link_, now, may_send);
+	if (this->proxy_link_ != nullptr)
+		this->receive_frames_(*this->proxy_link_, now, &PaceBms::process_proxy_request_);
+}
 
+void PaceBms::loop_link_(link& link, uint32_t now, bool may_send) {
 	// if there is no request active, throw away any incoming data before proceeding
-	if (this->request_outstanding_ == false &&
-		this->available() != 0) {
-		ESP_LOGV(TAG, "Throwing away incoming data because there is no request active");
+	if (link.request_outstanding_ == false &&
+		link.uart_->available() != 0) {
+		ESP_LOGV(TAG, "Throwing away incoming data on %s uart because there is no request active", link.name_);
 		uint8_t byte;
-		while (this->available() != 0) {
-			this->read_byte(&byte);
+		while (link.uart_->available() != 0) {
+			link.uart_->read_byte(&byte);
+		}
+#ifdef USE_ESP_IDF
+		// along with any EOI positions the driver recorded in it
+		if (link.pattern_detect_uart_num_ >= 0) {
+			while (uart_pattern_pop_pos((uart_port_t) link.pattern_detect_uart_num_) != -1) {
+			}
 		}
+#endif
 	}
 
-	const uint32_t now = millis();
+	// if no request is active and we are not throttled, send whatever is next among the commands this link carries
+	if (may_send &&
+		link.request_outstanding_ == false &&
+		now - link.last_transmit_ >= this->request_throttle_) {
+		PaceBms::command_item* command;
+		if (link.retry_command_ != nullptr) {
+			// the link is held for a retry until its backoff has passed
+			if ((int32_t) (now - link.retry_at_) < 0)
+				return;
+			command = link.retry_command_;
+			link.retry_command_ = nullptr;
+		}
+		else {
+			command = this->scheduler_.pop(now, link.priorities_);
+		}
+		if (command == nullptr)
+			return;
+		this->start_request_(link, command, now);
+		return;
+	}
 
-	// if no request is active, we are not throttled, and there are pending requests to send, do so
-	if (this->request_outstanding_ == false &&
-		now - this->last_transmit_ >= this->request_throttle_ &&
-		(this->read_queue_.size() > 0 || this->write_queue_.size() > 0)) {
-		// this will do any desired logging
-		this->send_next_request_frame_();
-		this->request_outstanding_ = true;
-		this->last_transmit_ = now;
-		this->last_receive_ = now;
-		this->raw_data_index_ = 0;
+#ifdef USE_ESP_IDF
+	if (link.pattern_detect_uart_num_ >= 0 && link.request_outstanding_ == true) {
+		this->receive_pattern_detect_(link, now);
 		return;
 	}
+#endif
 
 	// if a request is active but we have passed the response timeout period and no more data is available, abandon the request
-	if (this->request_outstanding_ == true &&
-		now - this->last_receive_ >= this->response_timeout_ &&
-		this->available() == 0) {
-		if (this->raw_data_index_ > 0) {
-			std::string str(this->raw_data_, this->raw_data_ + this->raw_data_index_ + 1);
-			ESP_LOGW(TAG, "Response frame timeout for request %s after %i ms, partial frame: %s", this->last_request_description.c_str(), now - this->last_receive_, str.c_str());
+	if (link.request_outstanding_ == true &&
+		now - link.last_receive_ >= this->response_timeout_ &&
+		link.uart_->available() == 0) {
+		this->abandon_request_(link, now);
+		return;
+	}
+
+	// if no data or no request outstanding, nothing to do
+	if (link.uart_->available() == 0 ||
+		link.request_outstanding_ == false) {
+		return;
+	}
+
+	// take everything that has arrived (that fits) in one read, a frame will usually span a few of these
+	size_t received_length = std::min((size_t) link.uart_->available(), (size_t) (this->max_data_len_ - link.raw_data_index_));
+	link.uart_->read_array(link.raw_data_ + link.raw_data_index_, received_length);
+	size_t length = link.raw_data_index_ + received_length;
+
+	// rather than giving up on the request at the first byte that isn't SOI, skip past line noise and the echo of our 
+	//     own request (some transceivers do that) to the response, which is often right behind them
+	size_t start = 0;
+	while (start < length) {
+		// with EOI in hand the frame is whatever follows the last SOI before it, otherwise it's still on its way in
+		const uint8_t* eoi = (const uint8_t*) memchr(link.raw_data_ + start, '\r', length - start);
+		const uint8_t* soi = nullptr;
+		if (eoi != nullptr) {
+			for (size_t i = eoi - link.raw_data_; i > start && soi == nullptr; i--) {
+				if (link.raw_data_[i - 1] == '~')
+					soi = link.raw_data_ + i - 1;
+			}
 		}
 		else {
-			ESP_LOGW(TAG, "Response frame timeout for request %s after %i ms, no valid data received", this->last_request_description.c_str(), now - this->last_receive_);
+			soi = (const uint8_t*) memchr(link.raw_data_ + start, '~', length - start);
+		}
+		size_t skipped = (soi != nullptr ? soi : eoi != nullptr ? eoi + 1 : link.raw_data_ + length) - (link.raw_data_ + start);
+		if (skipped != 0) {
+			ESP_LOGV(TAG, "Skipping %u bytes of noise ahead of the response on %s uart", (unsigned) skipped, link.name_);
+			if (this->frame_capture_ != nullptr)
+				this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_ + start, skipped);
+			start += skipped;
+			continue;
 		}
-		request_outstanding_ = false;
-		this->raw_data_index_ = 0;
+		if (eoi == nullptr)
+			break;
+
+		uint8_t* frame = link.raw_data_ + start;
+		uint16_t frame_length = eoi - frame + 1;
+		if (this->is_request_echo_(link, frame, frame_length)) {
+			ESP_LOGV(TAG, "Skipping the echo of our own request on %s uart", link.name_);
+			start += frame_length;
+			continue;
+		}
+		if (this->frame_capture_ != nullptr)
+			this->frame_capture_->record(PaceBmsFrameCapture::RECORD_RESPONSE, micros(), frame, frame_length);
+		// this will do any desired logging, anything after the frame is thrown away with the next loop's check for unrequested data
+		if (this->process_response_frame_(link, frame, frame_length))
+			this->finish_request_(link, now);
+		else
+			this->fail_request_(link, now);
 		return;
 	}
 
-	// if no data or no request outstanding, nothing to do
-	if (this->available() == 0 ||
-		this->request_outstanding_ == false) {
+	// keep the start of the response at the front of the buffer, noise alone doesn't hold off the response timeout
+	length -= start;
+	if (length != 0) {
+		if (start != 0)
+			memmove(link.raw_data_, link.raw_data_ + start, length);
+		link.last_receive_ = now;
+	}
+
+	// did we run out of buffer before EOI?
+	if (length >= this->max_data_len_) {
+		if (this->frame_capture_ != nullptr)
+			this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_, length);
+		std::string str(link.raw_data_, link.raw_data_ + length);
+		ESP_LOGV(TAG, "Response frame exceeds maximum supported length, last request was '%s', incomplete response frame: %s", link.request_description_.c_str(), str.c_str());
+		this->failure_counts_.corrupt_responses++;
+		this->fail_request_(link, now);
 		return;
 	}
 
-	// reset timer since we're actively receiving
-	this->last_receive_ = now;
+	link.raw_data_index_ = length;
+}
 
-	while (this->available() != 0) {
-		this->read_byte(&this->raw_data_[this->raw_data_index_]);
+// compared by length and checksum rather than keeping a copy of every request around, a response matching both is 
+//     vanishingly unlikely
+bool PaceBms::is_request_echo_(const link& link, const uint8_t* frame_bytes, uint16_t frame_length) {
+	return frame_length == link.request_length_ && frame_length >= 5 &&
+		memcmp(frame_bytes + frame_length - 5, link.request_checksum_, sizeof(link.request_checksum_)) == 0;
+}
+
+// keeps the first copy of each read, they're identical from one update() to the next
+void PaceBms::listen_for_read_(command_item* item) {
+	for (const listened_read& listened : this->listened_reads_) {
+		if (listened.command_->description_ == item->description_) {
+			delete item;
+			return;
+		}
+	}
+
+	std::vector<uint8_t> request;
+	int16_t address = -1;
+	int16_t cid2 = -1;
+	if (item->create_request_frame_(request) && request.size() >= 9) {
+		address = decode_hex_byte_(request.data() + 3);
+		cid2 = decode_hex_byte_(request.data() + 7);
+	}
+	if (address < 0 || cid2 < 0) {
+		ESP_LOGE(TAG, "Error creating '%s' request frame", item->description_.c_str());
+		delete item;
+		return;
+	}
+	ESP_LOGV(TAG, "Listening for '%s' requests (ADR 0x%02X CID2 0x%02X)", item->description_.c_str(), address, cid2);
+	this->listened_reads_.push_back({ (uint8_t) address, (uint8_t) cid2, item });
+}
+
+// nothing is sent, every frame on the bus is read and the responses to another master's reads of this address are 
+//     decoded just as if this had made the request
+void PaceBms::loop_listen_(uint32_t now) {
+	link& link = this->primary_link_;
+
+	// a write (or the read back after one) can't go out without putting a request on the bus
+	PaceBms::command_item* command;
+	while ((command = this->scheduler_.pop(now)) != nullptr) {
+		ESP_LOGW(TAG, "Not sending '%s' request, listen_only is set", command->description_.c_str());
+		delete command;
+	}
+
+	this->receive_frames_(link, now, &PaceBms::process_listened_frame_);
+}
+
+void PaceBms::receive_frames_(link& link, uint32_t now, frame_handler handler) {
+	size_t available = link.uart_->available();
+	while (available != 0) {
+		size_t received_length = std::min(available, (size_t) (this->max_data_len_ - link.raw_data_index_));
+		link.uart_->read_array(link.raw_data_ + link.raw_data_index_, received_length);
+		available -= received_length;
+		size_t length = link.raw_data_index_ + received_length;
+
+		// with nothing to time a frame against there can be more than one per read, a frame is whatever follows the 
+		//     last SOI before each EOI, anything ahead of that lost its own EOI (or was never a frame)
+		size_t start = 0;
+		const uint8_t* eoi;
+		while ((eoi = (const uint8_t*) memchr(link.raw_data_ + start, '\r', length - start)) != nullptr) {
+			size_t end = eoi - link.raw_data_;
+			size_t soi = end;
+			while (soi > start && link.raw_data_[soi] != '~')
+				soi--;
+			if (link.raw_data_[soi] == '~')
+				(this->*handler)(link, link.raw_data_ + soi, end - soi + 1, now);
+			start = end + 1;
+		}
+
+		// keep the start of a frame that's still coming in, and nothing else
+		const uint8_t* soi = (const uint8_t*) memchr(link.raw_data_ + start, '~', length - start);
+		length = soi == nullptr ? 0 : link.raw_data_ + length - soi;
+		if (length >= this->max_data_len_) {
+			if (this->frame_capture_ != nullptr)
+				this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_, length);
+			ESP_LOGV(TAG, "Frame on %s uart exceeds maximum supported length, discarding it", link.name_);
+			length = 0;
+		}
+		else if (length != 0 && soi != link.raw_data_) {
+			memmove(link.raw_data_, soi, length);
+		}
+		link.raw_data_index_ = length;
+	}
+}
+
+// the request and the response look alike apart from CID2 being the RTN code in a response, so a frame is taken as a 
+//     request when it's one of the reads being listened for and otherwise as the response to whatever request came before 
+//     it, as long as that was recent enough
+void PaceBms::process_listened_frame_(link& link, uint8_t* frame_bytes, uint16_t frame_length, uint32_t now) {
+	// ~ VER ADR CID1 CID2 LENGTH CHKSUM \r is the shortest possible frame
+	int16_t address = frame_length >= 18 ? decode_hex_byte_(frame_bytes + 3) : -1;
+	int16_t cid2 = frame_length >= 18 ? decode_hex_byte_(frame_bytes + 7) : -1;
+	if (address < 0 || cid2 < 0) {
+		ESP_LOGV(TAG, "Ignoring malformed frame on the bus");
+		if (this->frame_capture_ != nullptr)
+			this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), frame_bytes, frame_length);
+		link.next_response_handler_ = nullptr;
+		return;
+	}
+
+	for (const listened_read& listened : this->listened_reads_) {
+		if (listened.address_ == address && listened.cid2_ == cid2) {
+			ESP_LOGD(TAG, "Heard '%s' request", listened.command_->description_.c_str());
+			if (this->frame_capture_ != nullptr)
+				this->frame_capture_->record(PaceBmsFrameCapture::RECORD_REQUEST, micros(), frame_bytes, frame_length);
+			link.next_response_handler_ = listened.command_->process_response_frame_;
+			link.request_description_ = listened.command_->description_;
+			link.last_transmit_ = now;
+			this->listened_request_address_ = address;
+			return;
+		}
+	}
 
-		// is the SOI marker present at byte 0?
-		if (this->raw_data_index_ == 0 && this->raw_data_[this->raw_data_index_] != '~') {
-			ESP_LOGV(TAG, "Response frame does not begin with '~', actual: 0x%02X = '%c'", this->raw_data_[this->raw_data_index_], this->raw_data_[this->raw_data_index_]);
-			request_outstanding_ = false;
-			this->raw_data_index_ = 0;
+	// a request for another pack, a write, a read that isn't being listened for, or a response to one of those
+	if (link.next_response_handler_ == nullptr ||
+		now - link.last_transmit_ >= this->response_timeout_ ||
+		address != this->listened_request_address_) {
+		ESP_LOGVV(TAG, "Ignoring frame on the bus (ADR 0x%02X CID2 0x%02X)", address, cid2);
+		link.next_response_handler_ = nullptr;
+		return;
+	}
+
+	if (this->frame_capture_ != nullptr)
+		this->frame_capture_->record(PaceBmsFrameCapture::RECORD_RESPONSE, micros(), frame_bytes, frame_length);
+	// this will do any desired logging
+	this->process_response_frame_(link, frame_bytes, frame_length);
+}
+
+// a client's request is answered straight from the cache if the same request was answered recently enough, so however 
+//     many clients there are the pack only ever sees this hub's own polling plus whatever can't be cached
+void PaceBms::process_proxy_request_(link& link, uint8_t* frame_bytes, uint16_t frame_length, uint32_t now) {
+	uint32_t ttl = this->proxy_cache_ttl_ != 0 ? this->proxy_cache_ttl_ : 2 * this->get_update_interval();
+	uint32_t age;
+	const std::vector<uint8_t>* cached = this->proxy_cache_.lookup(frame_bytes, frame_length, now, ttl, &age);
+	if (cached != nullptr) {
+		ESP_LOGD(TAG, "Answering proxy request from cache (%u ms old)", (unsigned) age);
+		this->write_frame_(link, cached->data(), cached->size());
+		return;
+	}
+
+	// a write, a read this hub doesn't make itself, or one that was cached too long ago, it goes to the pack ahead of 
+	//     anything else since the client is waiting on it
+	ESP_LOGD(TAG, "Forwarding proxy request to the pack");
+	command_item* item = new command_item;
+	item->description_ = std::string("proxy request");
+	// the client does its own retrying
+	item->retry_ = false;
+	// the client may be talking to another pack on the bus, or sending something that gets no reply, neither of which 
+	//     should take this hub offline (or bring it back)
+	item->own_request_ = false;
+	std::vector<uint8_t> request(frame_bytes, frame_bytes + frame_length);
+	item->create_request_frame_ = [request](std::vector<uint8_t>& frame) -> bool { frame = request; return true; };
+	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->write_frame_(*this->proxy_link_, response.data(), response.size()); };
+	this->scheduler_.push_next(item, PaceBmsScheduler::PRIORITY_WRITE, now);
+}
+
+// only good responses, to reads this hub makes itself (or an expired one of those forwarded for a client), since a 
+//     write can't be answered without actually writing
+void PaceBms::cache_response_(link& link, const uint8_t* frame_bytes, uint16_t frame_length) {
+	if (frame_length < 18 || decode_hex_byte_(frame_bytes + 7) != 0)
+		return;
+	this->proxy_cache_.store(link.request_frame_, frame_bytes, frame_length, link.request_cacheable_, millis());
+}
+
+int16_t PaceBms::decode_hex_byte_(const uint8_t* hex) {
+	int16_t value = 0;
+	for (uint8_t i = 0; i < 2; i++) {
+		uint8_t c = hex[i];
+		if (c >= '0' && c <= '9')
+			value = (value << 4) | (c - '0');
+		else if (c >= 'A' && c <= 'F')
+			value = (value << 4) | (c - 'A' + 10);
+		else if (c >= 'a' && c <= 'f')
+			value = (value << 4) | (c - 'a' + 10);
+		else
+			return -1;
+	}
+	return value;
+}
+
+// tries each candidate baud rate fastest first with a hardware version read, which every protocol version supports and 
+//     which has a response short enough to not take long to time out, and stays at the first that decodes cleanly
+void PaceBms::loop_baud_rate_probe_(uint32_t now) {
+	link& link = this->primary_link_;
+	if (link.request_outstanding_) {
+		this->loop_link_(link, now, false);
+		return;
+	}
+	if (now - link.last_transmit_ < this->request_throttle_)
+		return;
+
+	if (this->baud_rate_probe_sent_) {
+		uint32_t baud_rate = this->baud_rate_probe_[this->baud_rate_probe_index_];
+		if (this->baud_rate_probe_answered_) {
+			ESP_LOGI(TAG, "BMS answered at %u baud, using it", (unsigned) baud_rate);
+			this->finish_baud_rate_probe_();
+			return;
+		}
+		ESP_LOGD(TAG, "No clean response at %u baud", (unsigned) baud_rate);
+		this->baud_rate_probe_index_++;
+		if ((size_t) this->baud_rate_probe_index_ >= this->baud_rate_probe_.size()) {
+			ESP_LOGW(TAG, "BMS did not answer at any probed baud rate, staying at the configured %u", (unsigned) this->configured_baud_rate_);
+			this->set_baud_rate_(this->configured_baud_rate_);
+			this->finish_baud_rate_probe_();
 			return;
 		}
+	}
+
+	this->set_baud_rate_(this->baud_rate_probe_[this->baud_rate_probe_index_]);
+	this->baud_rate_probe_sent_ = true;
+	this->baud_rate_probe_answered_ = false;
+
+	command_item* item = new command_item;
+	item->description_ = std::string("probe baud rate");
+	// a rate the pack doesn't answer at is expected, and the next one is tried instead
+	item->retry_ = false;
+	if (this->pace_bms_v25_ != nullptr) {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void {
+			std::string hardware_version;
+			// with protocol_detect the version and chemistry may not be right yet, but any frame that got here intact was sent at the right rate
+			this->baud_rate_probe_answered_ = this->pace_bms_v25_->ProcessReadHardwareVersionResponse(this->address_, response, hardware_version) || this->protocol_detect_;
+		};
+	}
+	else {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void {
+			std::string hardware_version;
+			// with protocol_detect the version and chemistry may not be right yet, but any frame that got here intact was sent at the right rate
+			this->baud_rate_probe_answered_ = this->pace_bms_v20_->ProcessReadHardwareVersionResponse(this->address_, response, hardware_version) || this->protocol_detect_;
+		};
+	}
+	this->start_request_(link, item, now);
+}
 
-		// is this the end of a frame? process it
-		if (this->raw_data_[this->raw_data_index_] == '\r') {
-			// this will do any desired logging
-			this->process_response_frame_(this->raw_data_, this->raw_data_index_ + 1);
-			request_outstanding_ = false;
-			this->raw_data_index_ = 0;
+void PaceBms::finish_baud_rate_probe_() {
+	this->baud_rate_probe_index_ = -1;
+#ifdef USE_ESP_IDF
+	if (this->rx_pattern_detect_)
+		this->enable_pattern_detect_(this->primary_link_, this->parent_);
+#endif
+	// rather than waiting out the rest of update_interval for the first values
+	this->update();
+}
+
+void PaceBms::set_baud_rate_(uint32_t baud_rate) {
+	this->parent_->set_baud_rate(baud_rate);
+	this->parent_->load_settings(false);
+	// anything already received was at the old rate
+	uint8_t byte;
+	while (this->available() != 0) {
+		this->read_byte(&byte);
+	}
+}
+
+void PaceBms::start_protocol_detect_() {
+	uint8_t commandset = this->protocol_commandset_;
+	// what the protocol classes use when these aren't set
+	this->protocol_detect_configured_ = protocol_settings{ commandset,
+		this->protocol_version_.has_value() ? this->protocol_version_.value() : commandset,
+		this->chemistry_.has_value() ? this->chemistry_.value() : (uint8_t) 0x46 };
+
+	auto add = [this](const protocol_settings& settings) {
+		for (auto& candidate : this->protocol_detect_candidates_) {
+			if (candidate.version_ == settings.version_ && candidate.chemistry_ == settings.chemistry_)
+				return;
+		}
+		this->protocol_detect_candidates_.push_back(settings);
+	};
+	// each hub on a bus has an address of its own
+	this->protocol_detect_preference_ = global_preferences->make_preference<protocol_settings>(fnv1_hash("pace_bms_protocol_detect") ^ this->address_, true);
+	protocol_settings saved;
+	if (this->protocol_detect_preference_.load(&saved) && saved.commandset_ == commandset)
+		add(saved);
+	add(this->protocol_detect_configured_);
+	// VER is usually the commandset but some firmware reports another, and CID1 is 0x46 for LFP but not always
+	for (uint8_t version : { commandset, (uint8_t) 0x20, (uint8_t) 0x21, (uint8_t) 0x25, (uint8_t) 0x26 }) {
+		for (uint8_t chemistry : { (uint8_t) 0x46, (uint8_t) 0x4A, (uint8_t) 0x4F }) {
+			add(protocol_settings{ commandset, version, chemistry });
+		}
+	}
+	// the baud rate probe goes first and uses these too
+	this->apply_protocol_settings_(this->protocol_detect_candidates_[0]);
+	this->protocol_detect_index_ = 0;
+	this->protocol_detect_sent_ = false;
+}
+
+// much the same as the baud rate probe, a pack that's sent the wrong VER or CID1 usually answers with an error code, and 
+//     the header of that answer has the ones it does speak, so those are tried next rather than working through the list
+void PaceBms::loop_protocol_detect_(uint32_t now) {
+	link& link = this->primary_link_;
+	if (link.request_outstanding_) {
+		this->loop_link_(link, now, false);
+		return;
+	}
+	if (now - link.last_transmit_ < this->request_throttle_)
+		return;
+
+	if (this->protocol_detect_sent_) {
+		protocol_settings tried = this->protocol_detect_candidates_[this->protocol_detect_index_];
+		if (this->protocol_detect_answered_) {
+			ESP_LOGI(TAG, "BMS answered with protocol version 0x%02X and chemistry 0x%02X, using them", tried.version_, tried.chemistry_);
+			protocol_settings saved;
+			if (!this->protocol_detect_preference_.load(&saved) ||
+				saved.commandset_ != tried.commandset_ || saved.version_ != tried.version_ || saved.chemistry_ != tried.chemistry_)
+				this->protocol_detect_preference_.save(&tried);
+			this->finish_protocol_detect_();
 			return;
 		}
+		ESP_LOGD(TAG, "No answer with protocol version 0x%02X and chemistry 0x%02X", tried.version_, tried.chemistry_);
+		if (this->protocol_detect_heard_.has_value()) {
+			protocol_settings heard = this->protocol_detect_heard_.value();
+			auto& candidates = this->protocol_detect_candidates_;
+			size_t next = this->protocol_detect_index_ + 1;
+			size_t i = 0;
+			while (i < candidates.size() && (candidates[i].version_ != heard.version_ || candidates[i].chemistry_ != heard.chemistry_))
+				i++;
+			// unless it's already been tried without decoding, which can only mean something else is wrong
+			if (i >= next) {
+				if (i < candidates.size())
+					candidates.erase(candidates.begin() + i);
+				candidates.insert(candidates.begin() + next, heard);
+				ESP_LOGD(TAG, "BMS answered in protocol version 0x%02X and chemistry 0x%02X, trying those next", heard.version_, heard.chemistry_);
+			}
+		}
+		this->protocol_detect_index_++;
+		if ((size_t) this->protocol_detect_index_ >= this->protocol_detect_candidates_.size()) {
+			ESP_LOGW(TAG, "BMS did not answer with any protocol version and chemistry, staying with the configured 0x%02X and 0x%02X",
+				this->protocol_detect_configured_.version_, this->protocol_detect_configured_.chemistry_);
+			this->apply_protocol_settings_(this->protocol_detect_configured_);
+			this->finish_protocol_detect_();
+			return;
+		}
+	}
+
+	this->apply_protocol_settings_(this->protocol_detect_candidates_[this->protocol_detect_index_]);
+	this->protocol_detect_sent_ = true;
+	this->protocol_detect_answered_ = false;
+	this->protocol_detect_heard_.reset();
 
-		// did we run out of buffer before EOI?
-		if (this->raw_data_index_ + 1 >= this->max_data_len_) {
-			std::string str(this->raw_data_, this->raw_data_ + this->raw_data_index_ + 1);
-			ESP_LOGV(TAG, "Response frame exceeds maximum supported length, last request was '%s', incomplete response frame: %s", this->last_request_description.c_str(), str.c_str());
-			request_outstanding_ = false;
-			this->raw_data_index_ = 0;
+	command_item* item = new command_item;
+	item->description_ = std::string("detect protocol");
+	// the wrong version or chemistry gets no answer at all from some packs, and the next one is tried instead
+	item->retry_ = false;
+	if (this->pace_bms_v25_ != nullptr) {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void {
+			std::string hardware_version;
+			this->handle_protocol_detect_response_(this->pace_bms_v25_->ProcessReadHardwareVersionResponse(this->address_, response, hardware_version), response);
+		};
+	}
+	else {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void {
+			std::string hardware_version;
+			this->handle_protocol_detect_response_(this->pace_bms_v20_->ProcessReadHardwareVersionResponse(this->address_, response, hardware_version), response);
+		};
+	}
+	this->start_request_(link, item, now);
+}
+
+void PaceBms::handle_protocol_detect_response_(bool decoded, std::vector<uint8_t>& response) {
+	this->protocol_detect_answered_ = decoded;
+	if (decoded || response.size() < 7)
+		return;
+	// SOI, then VER, ADR and CID1 as hex
+	int16_t version = decode_hex_byte_(response.data() + 1);
+	int16_t chemistry = decode_hex_byte_(response.data() + 5);
+	if (version >= 0 && chemistry >= 0)
+		this->protocol_detect_heard_ = protocol_settings{ (uint8_t) this->protocol_commandset_, (uint8_t) version, (uint8_t) chemistry };
+}
+
+void PaceBms::apply_protocol_settings_(const protocol_settings& settings) {
+	this->protocol_version_ = settings.version_;
+	this->chemistry_ = settings.chemistry_;
+	// nothing has been queued yet, so there are no read request frames built with the old ones to throw away
+	this->create_protocol_();
+}
+
+void PaceBms::finish_protocol_detect_() {
+	this->protocol_detect_index_ = -1;
+	this->protocol_detect_candidates_.clear();
+	this->protocol_detect_candidates_.shrink_to_fit();
+	// rather than waiting out the rest of update_interval for the first values
+	this->update();
+}
+
+void PaceBms::start_address_scan() {
+	if (this->listen_only_) {
+		ESP_LOGW(TAG, "Can't scan for packs in listen only mode");
+		return;
+	}
+	if (this->baud_rate_probe_index_ >= 0 || this->protocol_detect_index_ >= 0 || this->address_scan_address_ >= 0) {
+		ESP_LOGW(TAG, "Can't scan for packs until the %s is done", this->address_scan_address_ >= 0 ? "current scan" : "startup probe");
+		return;
+	}
+	ESP_LOGI(TAG, "Scanning addresses 0 to %u for packs", (unsigned) (address_scan_count_ - 1));
+	this->address_scan_address_ = 0;
+	this->address_scan_sent_ = false;
+	this->address_scan_answered_ = false;
+	this->address_scan_serial_number_sent_ = false;
+	this->address_scan_result_.clear();
+}
+
+// each address is probed with a hardware version read, which every protocol version and variant answers (the EG4 
+//     variant has no serial number to give), and only an address that answered is then asked for its serial number 
+//     so the packs found can be told apart, the next request goes out the moment the last one is done rather than 
+//     after request_throttle, there's no conversation with any one pack for the throttle to protect
+void PaceBms::loop_address_scan_(uint32_t now) {
+	link& link = this->primary_link_;
+	if (link.request_outstanding_) {
+		// a pack that's there starts answering well inside this, and no answer is expected rather than counted as a timeout
+		if (this->address_scan_sent_ &&
+			now - link.last_receive_ >= address_scan_timeout_ &&
+			link.uart_->available() == 0) {
+			ESP_LOGV(TAG, "No answer at address %u", (unsigned) this->address_scan_address_);
+			this->finish_request_(link, now);
+		}
+		else {
+			// either the scan's own request or whatever was already outstanding when the scan was started
+			this->loop_link_(link, now, false);
 			return;
 		}
+	}
+
+	uint8_t address = this->address_scan_address_;
+	if (this->address_scan_sent_) {
+		if (this->address_scan_answered_ && this->address_scan_serial_number_sent_) {
+			ESP_LOGI(TAG, "Found a pack at address %u, serial number %s", (unsigned) address, this->address_scan_serial_number_.c_str());
+			if (!this->address_scan_result_.empty())
+				this->address_scan_result_ += ", ";
+			this->address_scan_result_ += std::to_string(address) + ": " + this->address_scan_serial_number_;
+		}
+		if (!this->address_scan_answered_ || this->address_scan_serial_number_sent_) {
+			this->address_scan_answered_ = false;
+			this->address_scan_serial_number_sent_ = false;
+			this->address_scan_address_++;
+			address = this->address_scan_address_;
+			if (this->address_scan_address_ >= address_scan_count_) {
+				if (this->address_scan_result_.empty())
+					this->address_scan_result_ = "none found";
+				ESP_LOGI(TAG, "Address scan done: %s", this->address_scan_result_.c_str());
+				for (int i = 0; i < this->address_scan_callbacks_.size(); i++) {
+					address_scan_callbacks_[i](this->address_scan_result_);
+				}
+				this->address_scan_address_ = -1;
+				this->address_scan_sent_ = false;
+				// rather than waiting out the rest of update_interval for the next values
+				this->update();
+				return;
+			}
+		}
+		else {
+			// the probe was answered, the serial number read goes to the same address
+			this->address_scan_serial_number_sent_ = true;
+		}
+	}
+	this->address_scan_sent_ = true;
+	// throws away a late answer from the last request, so it isn't taken for this one's
+	this->loop_link_(link, now, false);
 
-		this->raw_data_index_++;
+	command_item* item = new command_item;
+	// nothing being there is the answer most of the time
+	item->retry_ = false;
+	// and whatever does answer is most likely another pack, neither says anything about whether this hub's is there
+	item->own_request_ = false;
+	if (!this->address_scan_serial_number_sent_) {
+		item->description_ = std::string("scan address ") + std::to_string(address);
+		// anything that answers with a good checksum is a pack, whether or not the response decodes
+		if (this->pace_bms_v25_ != nullptr)
+			item->create_request_frame_ = [this, address](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(address, request); };
+		else
+			item->create_request_frame_ = [this, address](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(address, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>&) -> void {
+			this->address_scan_answered_ = true;
+			// kept if the serial number read doesn't get one
+			this->address_scan_serial_number_ = "unknown";
+		};
+	}
+	else {
+		item->description_ = std::string("read serial number at address ") + std::to_string(address);
+		if (this->pace_bms_v25_ != nullptr) {
+			item->create_request_frame_ = [this, address](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadSerialNumberRequest(address, request); };
+			item->process_response_frame_ = [this, address](std::vector<uint8_t>& response) -> void {
+				std::string serial_number;
+				if (this->pace_bms_v25_->ProcessReadSerialNumberResponse(address, response, serial_number))
+					this->address_scan_serial_number_ = serial_number;
+			};
+		}
+		else {
+			item->create_request_frame_ = [this, address](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadSerialNumberRequest(address, request); };
+			item->process_response_frame_ = [this, address](std::vector<uint8_t>& response) -> void {
+				std::string serial_number;
+				if (this->pace_bms_v20_->ProcessReadSerialNumberResponse(address, response, serial_number))
+					this->address_scan_serial_number_ = serial_number;
+			};
+		}
 	}
+	this->start_request_(link, item, now);
 }
 
-// pops the next item off of this->command_queue_, generates and dispatches a request frame, and sets up this->next_response_handler_
-void PaceBms::send_next_request_frame_() {
+void PaceBms::abandon_request_(link& link, uint32_t now) {
+	if (this->frame_capture_ != nullptr)
+		this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_, link.raw_data_index_);
+	if (link.raw_data_index_ > 0) {
+		std::string str(link.raw_data_, link.raw_data_ + link.raw_data_index_ + 1);
+		ESP_LOGW(TAG, "Response frame timeout for request %s after %i ms, partial frame: %s", link.request_description_.c_str(), now - link.last_receive_, str.c_str());
+	}
+	else {
+		ESP_LOGW(TAG, "Response frame timeout for request %s after %i ms, no valid data received", link.request_description_.c_str(), now - link.last_receive_);
+	}
+	this->failure_counts_.timeouts++;
+	// fail_request_ hands the command on, so this has to be looked at first
+	bool own_request = this->is_own_request_(link);
+	this->fail_request_(link, now);
+	// the startup probes expect to go unanswered now and then
+	if (own_request && this->offline_timeouts_ != 0 && !this->offline_ &&
+		this->baud_rate_probe_index_ < 0 && this->protocol_detect_index_ < 0 &&
+		++this->consecutive_timeouts_ >= this->offline_timeouts_)
+		this->go_offline_(now);
+}
+
+// frames picked up in listen_only mode have no command, they're only ever matched to a request to this hub's address
+bool PaceBms::is_own_request_(const link& link) {
+	return link.command_ == nullptr || link.command_->own_request_;
+}
+
+void PaceBms::go_offline_(uint32_t now) {
+	ESP_LOGW(TAG, "BMS hasn't answered %u requests in a row, it may be asleep or switched off, only checking on it now and then until it does", 
+		(unsigned) this->consecutive_timeouts_);
+	this->offline_ = true;
+	this->status_set_warning();
+
+	// everything already waiting would only time out too, writes are kept since they were asked for
+	size_t dropped = this->scheduler_.drop_reads();
+	for (link* link : { &this->primary_link_, this->secondary_link_ }) {
+		if (link != nullptr && link->retry_command_ != nullptr && link->retry_command_->priority_ != PaceBmsScheduler::PRIORITY_WRITE) {
+			delete link->retry_command_;
+			link->retry_command_ = nullptr;
+			dropped++;
+		}
+	}
+	ESP_LOGD(TAG, "Dropped %u queued reads", (unsigned) dropped);
+
+	// regardless of stale_timeout, the values aren't going to be refreshed
+	for (DataGroup group : { DATA_GROUP_ANALOG_INFORMATION, DATA_GROUP_STATUS_INFORMATION }) {
+		if (this->received_[group] && !this->stale_[group])
+			this->mark_stale_(group);
+	}
+
+	this->offline_probe_interval_ = this->get_update_interval();
+	this->offline_probe_at_ = now + this->offline_probe_interval_;
+}
 
-	if (read_queue_.empty() && write_queue_.empty()) {
-		ESP_LOGE(TAG, "command queue empty on send_next_request_frame");
+// called from update() while offline, so the interval is only as fine grained as update_interval
+void PaceBms::queue_offline_probe_(uint32_t now) {
+	// this only gets a look once per update(), so like is_due_ a probe that comes due within half an update_interval 
+	//     goes now rather than a whole update_interval late
+	if ((int32_t) (now + this->get_update_interval() / 2 - this->offline_probe_at_) < 0)
 		return;
+
+	command_item* item = new command_item;
+	item->description_ = std::string("read hardware version");
+	// no answer is what's expected, the next probe is as good as a retry
+	item->retry_ = false;
+	if (this->pace_bms_v25_ != nullptr) {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v25(response); };
+	}
+	else {
+		item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateReadHardwareVersionRequest(this->address_, request); };
+		item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_hardware_version_response_v20(response); };
 	}
+	this->queue_read_(item, PaceBmsScheduler::PRIORITY_INFORMATION);
 
-	// always process writes first
-	PaceBms::command_item* command;
-	if (!write_queue_.empty()) {
-		command = write_queue_.front();
-		write_queue_.pop_front();
+	uint32_t max_interval = std::max(this->offline_max_interval_, this->get_update_interval());
+	this->offline_probe_interval_ = std::min(this->offline_probe_interval_ * 2, max_interval);
+	this->offline_probe_at_ = now + this->offline_probe_interval_;
+	ESP_LOGD(TAG, "Checking whether the BMS is answering again, the next check is in %u ms if not", (unsigned) this->offline_probe_interval_);
+}
+
+// a timeout or a response damaged on the way is worth sending the same request again for (unlike one the pack answered 
+//     with an error), after a backoff that doubles each time, rather than waiting a whole update_interval for another go
+void PaceBms::fail_request_(link& link, uint32_t now) {
+	command_item* command = link.command_;
+	if (command != nullptr && command->retry_ && command->attempts_ <= this->max_retries_) {
+		uint32_t backoff = this->retry_backoff_ << (command->attempts_ - 1);
+		ESP_LOGD(TAG, "Retrying '%s' in %u ms", command->description_.c_str(), (unsigned) backoff);
+		this->failure_counts_.retries++;
+		link.retry_command_ = command;
+		link.retry_at_ = now + backoff;
+		link.command_ = nullptr;
 	}
 	else {
-		command = read_queue_.front();
-		read_queue_.pop();
+		if (command != nullptr && command->attempts_ > 1)
+			ESP_LOGW(TAG, "Giving up on '%s' after %u attempts", command->description_.c_str(), command->attempts_);
+		this->failure_counts_.failed_requests++;
+	}
+	this->finish_request_(link, now);
+}
+
+#ifdef USE_ESP_IDF
+// the driver's rx interrupt records where each EOI lands in its buffer, so until one has arrived there's nothing to read,
+//     only whether bytes are still coming in (for the response timeout) to check
+void PaceBms::receive_pattern_detect_(link& link, uint32_t now) {
+	const uart_port_t uart_num = (uart_port_t) link.pattern_detect_uart_num_;
+
+	size_t available = link.uart_->available();
+	if (available != link.pattern_detect_available_) {
+		link.pattern_detect_available_ = available;
+		link.last_receive_ = now;
+	}
+
+	int position = uart_pattern_get_pos(uart_num);
+	if (position < 0) {
+		if (now - link.last_receive_ >= this->response_timeout_) {
+			// pull in whatever partial frame there is for the log, and drop anything past what fits
+			link.raw_data_index_ = std::min(available, (size_t) this->max_data_len_ - 1);
+			link.uart_->read_array(link.raw_data_, link.raw_data_index_);
+			uint8_t byte;
+			while (link.uart_->available() != 0) {
+				link.uart_->read_byte(&byte);
+			}
+			link.pattern_detect_available_ = 0;
+			this->abandon_request_(link, now);
+		}
+		return;
 	}
+	uart_pattern_pop_pos(uart_num);
+	link.pattern_detect_available_ = 0;
 
-	// process_response_frame_ will call this on the next frame received
-	this->next_response_handler_ = command->process_response_frame_;
-	// saved for logging
-	this->last_request_description = command->description_;
+	size_t frame_length = position + 1;
+	if (frame_length > this->max_data_len_) {
+		link.uart_->read_array(link.raw_data_, this->max_data_len_);
+		uint8_t byte;
+		for (size_t i = this->max_data_len_; i < frame_length; i++)
+			link.uart_->read_byte(&byte);
+		if (this->frame_capture_ != nullptr)
+			this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_, this->max_data_len_);
+		std::string str(link.raw_data_, link.raw_data_ + this->max_data_len_);
+		ESP_LOGV(TAG, "Response frame exceeds maximum supported length, last request was '%s', incomplete response frame: %s", link.request_description_.c_str(), str.c_str());
+		this->failure_counts_.corrupt_responses++;
+		this->fail_request_(link, now);
+		return;
+	}
 
-	std::vector<uint8_t> request;
-	if (false == command->create_request_frame_(request)) {
-		ESP_LOGE(TAG, "Error creating '%s' request frame", command->description_.c_str());
+	link.uart_->read_array(link.raw_data_, frame_length);
+	// as in loop_link_, the frame is whatever follows the last SOI, and noise or our own echo just means waiting for the next EOI
+	size_t soi = frame_length - 1;
+	while (soi > 0 && link.raw_data_[soi] != '~')
+		soi--;
+	if (soi != 0 || link.raw_data_[0] != '~') {
+		size_t skipped = link.raw_data_[soi] == '~' ? soi : frame_length;
+		ESP_LOGV(TAG, "Skipping %u bytes of noise ahead of the response on %s uart", (unsigned) skipped, link.name_);
+		if (this->frame_capture_ != nullptr)
+			this->frame_capture_->record(PaceBmsFrameCapture::RECORD_ABANDONED, micros(), link.raw_data_, skipped);
+		if (skipped == frame_length)
+			return;
+	}
+	uint8_t* frame = link.raw_data_ + soi;
+	frame_length -= soi;
+	if (this->is_request_echo_(link, frame, frame_length)) {
+		ESP_LOGV(TAG, "Skipping the echo of our own request on %s uart", link.name_);
 		return;
 	}
+	if (this->frame_capture_ != nullptr)
+		this->frame_capture_->record(PaceBmsFrameCapture::RECORD_RESPONSE, micros(), frame, frame_length);
+	// this will do any desired logging
+	if (this->process_response_frame_(link, frame, frame_length))
+		this->finish_request_(link, now);
+	else
+		this->fail_request_(link, now);
+}
+
+// interrupt on every EOI ('\r'), the idle gap settings only matter for multi-character patterns
+void PaceBms::enable_pattern_detect_(link& link, uart::UARTComponent* uart) {
+	int uart_num = static_cast<uart::IDFUARTComponent*>(uart)->get_hw_serial_number();
+	esp_err_t err = uart_enable_pattern_det_baud_intr((uart_port_t) uart_num, '\r', 1, 9, 0, 0);
+	if (err == ESP_OK)
+		err = uart_pattern_queue_reset((uart_port_t) uart_num, pattern_queue_length_);
+	if (err != ESP_OK) {
+		ESP_LOGW(TAG, "Unable to enable rx pattern detect on %s uart (%s), reading it byte by byte instead", link.name_, esp_err_to_name(err));
+		return;
+	}
+	link.pattern_detect_uart_num_ = uart_num;
+}
+#endif
+
+// the link is busy from sending a request until the response is in (or abandoned) and the throttle has passed, since
+//     it can't be used in between either way
+void PaceBms::finish_request_(link& link, uint32_t now) {
+	uint32_t busy = std::max(now - link.last_transmit_, (uint32_t) this->request_throttle_);
+	link.busy_time_ += busy;
+	node_busy_time_ += busy;
+	link.request_outstanding_ = false;
+	link.raw_data_index_ = 0;
+	delete link.command_;
+	link.command_ = nullptr;
+}
+
+uint64_t PaceBms::get_busy_time() {
+	uint64_t busy_time = this->primary_link_.busy_time_;
+	if (this->secondary_link_ != nullptr)
+		busy_time += this->secondary_link_->busy_time_;
+	return busy_time;
+}
+
+// generates and dispatches a request frame for a command popped off the scheduler, and sets up link.next_response_handler_
+bool PaceBms::send_request_frame_(link& link, command_item* command) {
+	uint32_t now = millis();
+	if ((int32_t) (now - command->deadline_) > 0) {
+		ESP_LOGD(TAG, "'%s' missed its deadline by %u ms", command->description_.c_str(), (unsigned) (now - command->deadline_));
+	}
+
+	// reads come with their frame already built, see get_read_request_frame_
+	std::vector<uint8_t> created;
+	const std::vector<uint8_t>* request = command->request_frame_;
+	if (request == nullptr) {
+		if (false == command->create_request_frame_(created)) {
+			ESP_LOGE(TAG, "Error creating '%s' request frame", command->description_.c_str());
+			delete(command);
+			return false;
+		}
+		request = &created;
+	}
+
+	// process_response_frame_ will call this on the next frame received
+	link.next_response_handler_ = command->process_response_frame_;
+	// saved for logging
+	link.request_description_ = command->description_;
 
 	ESP_LOGD(TAG, "Sending '%s' request", command->description_.c_str());
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
 	{
-		std::string str(request.data(), request.data() + request.size());
+		std::string str(request->data(), request->data() + request->size());
 		ESP_LOGVV(TAG, "Request frame: %s", str.c_str());
 	}
 #endif
 
-	if (this->flow_control_pin_ != nullptr)
-		this->flow_control_pin_->digital_write(true);
-	this->write_array(request.data(), request.size());
+	if (this->frame_capture_ != nullptr)
+		this->frame_capture_->record(PaceBmsFrameCapture::RECORD_REQUEST, micros(), request->data(), request->size());
+
+	this->write_frame_(link, request->data(), request->size());
+	link.request_length_ = request->size();
+	if (request->size() >= 5)
+		memcpy(link.request_checksum_, request->data() + request->size() - 5, sizeof(link.request_checksum_));
+
+	if (this->proxy_link_ != nullptr) {
+		link.request_cacheable_ = command->priority_ != PaceBmsScheduler::PRIORITY_WRITE;
+		link.request_frame_ = *request;
+	}
+
+	// kept until the request is finished, in case it needs to be sent again
+	command->attempts_++;
+	delete link.command_;
+	link.command_ = command;
+	return true;
+}
+
+void PaceBms::write_frame_(link& link, const uint8_t* frame_bytes, size_t frame_length) {
+	if (link.flow_control_pin_ != nullptr)
+		link.flow_control_pin_->digital_write(true);
+	link.uart_->write_array(frame_bytes, frame_length);
 	// if flow control is required (rs485 does read+write on the same differential pair) then I don't see any other option than to block on flush()
 	// if using rs232, a flow control pin should not be assigned in yaml in order to avoid this block
-	if (this->flow_control_pin_ != nullptr) {
-		this->flush();
-		this->flow_control_pin_->digital_write(false);
+	if (link.flow_control_pin_ != nullptr) {
+		link.uart_->flush();
+		link.flow_control_pin_->digital_write(false);
 	}
+}
 
-	delete(command);
+void PaceBms::start_request_(link& link, command_item* command, uint32_t now) {
+	// this will do any desired logging
+	// nothing went out if the frame couldn't be created, so there's no response to wait for or time out on
+	if (!this->send_request_frame_(link, command))
+		return;
+	link.request_outstanding_ = true;
+	link.last_transmit_ = now;
+	link.last_receive_ = now;
+	link.raw_data_index_ = 0;
 }
 
-// calls this->next_response_handler_ (set up from the previously dispatched command_queue_ item)
-void PaceBms::process_response_frame_(uint8_t* frame_bytes, uint8_t frame_length) {
+// calls link.next_response_handler_ (set up from the previously dispatched command)
+bool PaceBms::process_response_frame_(link& link, uint8_t* frame_bytes, uint16_t frame_length) {
+	// the handlers log this, with two links it's whichever one the response came in on
+	this->last_request_description = link.request_description_;
+
 	ESP_LOGV(TAG, "Processing response frame for '%s' request", this->last_request_description.c_str());
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
 	{
@@ -463,15 +1550,76 @@ void PaceBms::process_response_frame_(uint8_t* frame_bytes, uint8_t frame_length
 
 	std::vector<uint8_t> response(frame_bytes, frame_bytes + frame_length);
 
-	if (next_response_handler_ != nullptr)
-		next_response_handler_(response);
+	PaceBmsProtocolBase* protocol = this->pace_bms_v25_ != nullptr ? (PaceBmsProtocolBase*) this->pace_bms_v25_ : (PaceBmsProtocolBase*) this->pace_bms_v20_;
+	if (!protocol->ValidateResponseChecksum(response)) {
+		ESP_LOGW(TAG, "Response frame for '%s' request failed its checksum", this->last_request_description.c_str());
+		this->failure_counts_.corrupt_responses++;
+		link.next_response_handler_ = nullptr;
+		return false;
+	}
+
+	// anything intact at all means the pack is there, even if it answered with an error, as long as the request was 
+	//     this hub's own (a proxy client's could have been answered by another pack)
+	if (this->is_own_request_(link)) {
+		this->consecutive_timeouts_ = 0;
+		if (this->offline_) {
+			ESP_LOGI(TAG, "BMS is answering again, resuming polling");
+			this->offline_ = false;
+			this->status_clear_warning();
+			this->resume_polling_ = true;
+		}
+	}
+
+	if (this->proxy_link_ != nullptr)
+		this->cache_response_(link, frame_bytes, frame_length);
+
+	if (link.next_response_handler_ != nullptr)
+		link.next_response_handler_(response);
 	else
 		ESP_LOGE(TAG, "Response frame received but no response handler set");
 
-	// this request/response pair is complete, any additional frames received will not be expected and should not be processed until the next command queue pop / send
-	next_response_handler_ = nullptr;
+	// this request/response pair is complete, any additional frames received will not be expected and should not be processed until the next command is sent
+	link.next_response_handler_ = nullptr;
+	return true;
 }
 
+/*
+* raw frame capture export
+*/
+
+void PaceBms::dump_frame_capture() {
+	if (this->frame_capture_ == nullptr) {
+		ESP_LOGW(TAG, "Frame capture is not enabled");
+		return;
+	}
+
+	ESP_LOGI(TAG, "Frame capture: %u frames, %u dropped", (unsigned) this->frame_capture_->get_record_count(), (unsigned) this->frame_capture_->get_dropped_count());
+	// one line per frame: "capture <micros> <type> <frame>", the frames are ASCII apart from EOI which is left off
+	// (abandoned partial frames can contain anything, so those are written as hex instead)
+	this->frame_capture_->for_each([](PaceBmsFrameCapture::RecordType type, uint32_t timestamp, const std::vector<uint8_t>& data) {
+		std::string frame;
+		if (type == PaceBmsFrameCapture::RECORD_ABANDONED)
+			frame = format_hex(data);
+		else
+			frame.assign(data.begin(), data.end() - (data.size() > 0 && data.back() == '\r' ? 1 : 0));
+		ESP_LOGI(TAG, "capture %" PRIu32 " %c %s", timestamp, (char) type, frame.c_str());
+	});
+}
+
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+void PaceBms::set_frame_capture_web_server(web_server_base::WebServerBase* web_server, const std::string& path) {
+	this->frame_capture_web_server_ = web_server;
+	this->frame_capture_web_path_ = path;
+}
+
+void PaceBmsFrameCaptureHandler::handleRequest(AsyncWebServerRequest* request) {
+	this->capture_->write_pcap(this->pcap_);
+	AsyncWebServerResponse* response = request->beginResponse_P(200, "application/vnd.tcpdump.pcap", this->pcap_.data(), this->pcap_.size());
+	response->addHeader("Content-Disposition", "attachment; filename=\"pace_bms.pcap\"");
+	request->send(response);
+}
+#endif
+
 /*
 * read/write response frame received handlers, called via next_response_handler_ from process_response_frame
 */
@@ -486,12 +1634,29 @@ void PaceBms::handle_read_analog_information_response_v25(std::vector<uint8_t>&
 		return;
 	}
 
+	this->mark_received_(DATA_GROUP_ANALOG_INFORMATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->analog_information_callbacks_v25_.size(); i++) {
 		analog_information_callbacks_v25_[i](analog_information);
 	}
 }
 
+void PaceBms::handle_read_remaining_capacity_response_v25(std::vector<uint8_t>& response) {
+	ESP_LOGD(TAG, "Processing '%s' response", this->last_request_description.c_str());
+
+	PaceBmsProtocolV25::RemainingCapacity remaining_capacity;
+	bool result = this->pace_bms_v25_->ProcessReadRemainingCapacityResponse(this->address_, response, remaining_capacity);
+	if (result == false) {
+		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
+		return;
+	}
+
+	// dispatch to any child components that registered for a callback with us
+	for (int i = 0; i < this->remaining_capacity_callbacks_v25_.size(); i++) {
+		remaining_capacity_callbacks_v25_[i](remaining_capacity);
+	}
+}
+
 void PaceBms::handle_read_status_information_response_v25(std::vector<uint8_t>& response) {
 	ESP_LOGD(TAG, "Processing '%s' response", this->last_request_description.c_str());
 
@@ -502,6 +1667,7 @@ void PaceBms::handle_read_status_information_response_v25(std::vector<uint8_t>&
 		return;
 	}
 
+	this->mark_received_(DATA_GROUP_STATUS_INFORMATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->status_information_callbacks_v25_.size(); i++) {
 		status_information_callbacks_v25_[i](status_information);
@@ -579,6 +1745,11 @@ void PaceBms::handle_read_protocols_response_v25(std::vector<uint8_t>& response)
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
+	// dispatch to any child components that registered for a callback with us
+	for (int i = 0; i < this->protocols_callbacks_v25_.size(); i++) {
+		protocols_callbacks_v25_[i](protocols);
+	}
 }
 
 void PaceBms::handle_write_protocols_response_v25(PaceBmsProtocolV25::Protocols protocols, std::vector<uint8_t>& response) {
@@ -589,6 +1760,7 @@ void PaceBms::handle_write_protocols_response_v25(PaceBmsProtocolV25::Protocols
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->configuration_queued_ = false;
 }
 
 void PaceBms::handle_read_cell_over_voltage_configuration_response_v25(std::vector<uint8_t>& response) {
@@ -600,6 +1772,7 @@ void PaceBms::handle_read_cell_over_voltage_configuration_response_v25(std::vect
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->cell_over_voltage_configuration_callbacks_v25_.size(); i++) {
 		cell_over_voltage_configuration_callbacks_v25_[i](config);
@@ -615,6 +1788,7 @@ void PaceBms::handle_read_pack_over_voltage_configuration_response_v25(std::vect
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->pack_over_voltage_configuration_callbacks_v25_.size(); i++) {
 		pack_over_voltage_configuration_callbacks_v25_[i](config);
@@ -630,6 +1804,7 @@ void PaceBms::handle_read_cell_under_voltage_configuration_response_v25(std::vec
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->cell_under_voltage_configuration_callbacks_v25_.size(); i++) {
 		cell_under_voltage_configuration_callbacks_v25_[i](config);
@@ -645,6 +1820,7 @@ void PaceBms::handle_read_pack_under_voltage_configuration_response_v25(std::vec
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->pack_under_voltage_configuration_callbacks_v25_.size(); i++) {
 		pack_under_voltage_configuration_callbacks_v25_[i](config);
@@ -661,6 +1837,7 @@ void PaceBms::handle_read_charge_over_current_configuration_response_v25(std::ve
 		return;
 	}
 
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->charge_over_current_configuration_callbacks_v25_.size(); i++) {
 		charge_over_current_configuration_callbacks_v25_[i](config);
@@ -676,6 +1853,7 @@ void PaceBms::handle_read_discharge_over_current1_configuration_response_v25(std
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->discharge_over_current1_configuration_callbacks_v25_.size(); i++) {
 		discharge_over_current1_configuration_callbacks_v25_[i](config);
@@ -691,6 +1869,7 @@ void PaceBms::handle_read_discharge_over_current2_configuration_response_v25(std
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->discharge_over_current2_configuration_callbacks_v25_.size(); i++) {
 		discharge_over_current2_configuration_callbacks_v25_[i](config);
@@ -706,6 +1885,7 @@ void PaceBms::handle_read_short_circuit_protection_configuration_response_v25(st
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->short_circuit_protection_configuration_callbacks_v25_.size(); i++) {
 		short_circuit_protection_configuration_callbacks_v25_[i](config);
@@ -721,6 +1901,7 @@ void PaceBms::handle_read_cell_balancing_configuration_response_v25(std::vector<
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->cell_balancing_configuration_callbacks_v25_.size(); i++) {
 		cell_balancing_configuration_callbacks_v25_[i](config);
@@ -736,6 +1917,7 @@ void PaceBms::handle_read_sleep_configuration_response_v25(std::vector<uint8_t>&
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->sleep_configuration_callbacks_v25_.size(); i++) {
 		sleep_configuration_callbacks_v25_[i](config);
@@ -751,6 +1933,7 @@ void PaceBms::handle_read_full_charge_low_charge_configuration_response_v25(std:
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->full_charge_low_charge_configuration_callbacks_v25_.size(); i++) {
 		full_charge_low_charge_configuration_callbacks_v25_[i](config);
@@ -766,6 +1949,7 @@ void PaceBms::handle_read_charge_and_discharge_over_temperature_configuration_re
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->charge_and_discharge_over_temperature_configuration_callbacks_v25_.size(); i++) {
 		charge_and_discharge_over_temperature_configuration_callbacks_v25_[i](config);
@@ -781,6 +1965,7 @@ void PaceBms::handle_read_charge_and_discharge_under_temperature_configuration_r
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->charge_and_discharge_under_temperature_configuration_callbacks_v25_.size(); i++) {
 		charge_and_discharge_under_temperature_configuration_callbacks_v25_[i](config);
@@ -795,6 +1980,8 @@ void PaceBms::handle_write_configuration_response_v25(std::vector<uint8_t>& resp
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	// don't make the user wait a whole configuration_interval to see what they just wrote
+	this->configuration_queued_ = false;
 }
 
 void PaceBms::handle_read_system_datetime_response_v25(std::vector<uint8_t>& response) {
@@ -821,6 +2008,7 @@ void PaceBms::handle_read_mosfet_over_temperature_configuration_response_v25(std
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->mosfet_over_temperature_configuration_callbacks_v25_.size(); i++) {
 		mosfet_over_temperature_configuration_callbacks_v25_[i](config);
@@ -836,6 +2024,7 @@ void PaceBms::handle_read_environment_over_under_temperature_configuration_respo
 		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
 		return;
 	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->environment_over_under_temperature_configuration_callbacks_v25_.size(); i++) {
 		environment_over_under_temperature_configuration_callbacks_v25_[i](config);
@@ -852,6 +2041,39 @@ void PaceBms::handle_write_system_datetime_response_v25(std::vector<uint8_t>& re
 	}
 }
 
+void PaceBms::handle_read_charge_current_limiter_start_current_response_v25(std::vector<uint8_t>& response) {
+	ESP_LOGD(TAG, "Processing '%s' response", this->last_request_description.c_str());
+
+	uint8_t current;
+	bool result = this->pace_bms_v25_->ProcessReadChargeCurrentLimiterStartCurrentResponse(this->address_, response, current);
+	if (result == false) {
+		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
+		return;
+	}
+	this->mark_received_(DATA_GROUP_CONFIGURATION);
+	// dispatch to any child components that registered for a callback with us
+	for (int i = 0; i < this->charge_current_limiter_start_current_callbacks_v25_.size(); i++) {
+		charge_current_limiter_start_current_callbacks_v25_[i](current);
+	}
+}
+
+void PaceBms::handle_write_charge_current_limiter_start_current_response_v25(uint8_t current, std::vector<uint8_t>& response) {
+	ESP_LOGD(TAG, "Processing '%s' response", this->last_request_description.c_str());
+
+	bool result = this->pace_bms_v25_->ProcessWriteChargeCurrentLimiterStartCurrentResponse(this->address_, response);
+	if (result == false) {
+		ESP_LOGE(TAG, "Unable to decode '%s' response", this->last_request_description.c_str());
+		return;
+	}
+
+	// read it straight back so the number shows what the BMS actually accepted, it jumps the queue so nothing else 
+	//     (including another write of this same value) gets between the write and its verification
+	command_item* item = this->create_read_charge_current_limiter_start_current_item_v25_();
+	item->description_ = std::string("verify charge current limiter start current");
+	this->scheduler_.push_next(item, PaceBmsScheduler::PRIORITY_WRITE, millis());
+	ESP_LOGV(TAG, "Queued '%s' of %u A", item->description_.c_str(), (unsigned) current);
+}
+
 
 void PaceBms::handle_read_analog_information_response_v20(std::vector<uint8_t>& response) {
 	ESP_LOGD(TAG, "Processing '%s' response", this->last_request_description.c_str());
@@ -863,6 +2085,7 @@ void PaceBms::handle_read_analog_information_response_v20(std::vector<uint8_t>&
 		return;
 	}
 
+	this->mark_received_(DATA_GROUP_ANALOG_INFORMATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->analog_information_callbacks_v20_.size(); i++) {
 		analog_information_callbacks_v20_[i](analog_information);
@@ -879,6 +2102,7 @@ void PaceBms::handle_read_status_information_response_v20(std::vector<uint8_t>&
 		return;
 	}
 
+	this->mark_received_(DATA_GROUP_STATUS_INFORMATION);
 	// dispatch to any child components that registered for a callback with us
 	for (int i = 0; i < this->status_information_callbacks_v20_.size(); i++) {
 		status_information_callbacks_v20_[i](status_information);
@@ -958,18 +2182,7 @@ void PaceBms::handle_write_system_datetime_response_v20(std::vector<uint8_t>& re
 
 // helper for when multiple writes are requested due to fast UX interaction
 void PaceBms::write_queue_push_back_with_deduplication(command_item* item) {
-	auto iter = std::find_if(this->write_queue_.begin(), this->write_queue_.end(),
-		[&item](const command_item* test) -> bool {
-			return test->description_ == item->description_;
-		});
-
-	if (iter != this->write_queue_.end()) {
-		std::swap((*iter), item);
-		delete item;
-	}
-	else {
-		this->write_queue_.push_back(item);
-	}
+	this->scheduler_.push_with_deduplication(item, PaceBmsScheduler::PRIORITY_WRITE, millis(), this->write_deadline_);
 }
 
 void PaceBms::write_switch_state_v25(PaceBmsProtocolV25::SwitchCommand state) {
@@ -998,7 +2211,7 @@ void PaceBms::write_switch_state_v25(PaceBmsProtocolV25::SwitchCommand state) {
 	item->create_request_frame_ = [this, state](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteSwitchCommandRequest(this->address_, state, request); };
 	item->process_response_frame_ = [this, state](std::vector<uint8_t>& response) -> void { this->handle_write_switch_command_response_v25(state, response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_mosfet_state_v25(PaceBmsProtocolV25::MosfetType type, PaceBmsProtocolV25::MosfetState state) {
@@ -1018,7 +2231,7 @@ void PaceBms::write_mosfet_state_v25(PaceBmsProtocolV25::MosfetType type, PaceBm
 	item->create_request_frame_ = [this, type, state](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteMosfetSwitchCommandRequest(this->address_, type, state, request); };
 	item->process_response_frame_ = [this, type, state](std::vector<uint8_t>& response) -> void { this->handle_write_mosfet_switch_command_response_v25(type, state, response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_shutdown_v25() {
@@ -1029,7 +2242,7 @@ void PaceBms::write_shutdown_v25() {
 	item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteShutdownCommandRequest(this->address_, request); };
 	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_write_shutdown_command_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_protocols_v25(PaceBmsProtocolV25::Protocols& protocols) {
@@ -1040,7 +2253,7 @@ void PaceBms::write_protocols_v25(PaceBmsProtocolV25::Protocols& protocols) {
 	item->create_request_frame_ = [this, protocols](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteProtocolsRequest(this->address_, protocols, request); };
 	item->process_response_frame_ = [this, protocols](std::vector<uint8_t>& response) -> void { this->handle_write_protocols_response_v25(protocols, response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_cell_over_voltage_configuration_v25(PaceBmsProtocolV25::CellOverVoltageConfiguration& config) {
@@ -1051,7 +2264,7 @@ void PaceBms::write_cell_over_voltage_configuration_v25(PaceBmsProtocolV25::Cell
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_pack_over_voltage_configuration_v25(PaceBmsProtocolV25::PackOverVoltageConfiguration& config) {
@@ -1062,7 +2275,7 @@ void PaceBms::write_pack_over_voltage_configuration_v25(PaceBmsProtocolV25::Pack
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_cell_under_voltage_configuration_v25(PaceBmsProtocolV25::CellUnderVoltageConfiguration& config) {
@@ -1073,7 +2286,7 @@ void PaceBms::write_cell_under_voltage_configuration_v25(PaceBmsProtocolV25::Cel
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_pack_under_voltage_configuration_v25(PaceBmsProtocolV25::PackUnderVoltageConfiguration& config) {
@@ -1084,7 +2297,7 @@ void PaceBms::write_pack_under_voltage_configuration_v25(PaceBmsProtocolV25::Pac
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_charge_over_current_configuration_v25(PaceBmsProtocolV25::ChargeOverCurrentConfiguration& config) {
@@ -1095,7 +2308,7 @@ void PaceBms::write_charge_over_current_configuration_v25(PaceBmsProtocolV25::Ch
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_discharge_over_current1_configuration_v25(PaceBmsProtocolV25::DischargeOverCurrent1Configuration& config) {
@@ -1106,7 +2319,7 @@ void PaceBms::write_discharge_over_current1_configuration_v25(PaceBmsProtocolV25
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_discharge_over_current2_configuration_v25(PaceBmsProtocolV25::DischargeOverCurrent2Configuration& config) {
@@ -1117,7 +2330,7 @@ void PaceBms::write_discharge_over_current2_configuration_v25(PaceBmsProtocolV25
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_short_circuit_protection_configuration_v25(PaceBmsProtocolV25::ShortCircuitProtectionConfiguration& config) {
@@ -1128,7 +2341,7 @@ void PaceBms::write_short_circuit_protection_configuration_v25(PaceBmsProtocolV2
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_cell_balancing_configuration_v25(PaceBmsProtocolV25::CellBalancingConfiguration& config) {
@@ -1139,7 +2352,7 @@ void PaceBms::write_cell_balancing_configuration_v25(PaceBmsProtocolV25::CellBal
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_sleep_configuration_v25(PaceBmsProtocolV25::SleepConfiguration& config) {
@@ -1150,7 +2363,7 @@ void PaceBms::write_sleep_configuration_v25(PaceBmsProtocolV25::SleepConfigurati
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_full_charge_low_charge_configuration_v25(PaceBmsProtocolV25::FullChargeLowChargeConfiguration& config) {
@@ -1161,7 +2374,7 @@ void PaceBms::write_full_charge_low_charge_configuration_v25(PaceBmsProtocolV25:
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_charge_and_discharge_over_temperature_configuration_v25(PaceBmsProtocolV25::ChargeAndDischargeOverTemperatureConfiguration& config) {
@@ -1172,7 +2385,7 @@ void PaceBms::write_charge_and_discharge_over_temperature_configuration_v25(Pace
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_charge_and_discharge_under_temperature_configuration_v25(PaceBmsProtocolV25::ChargeAndDischargeUnderTemperatureConfiguration& config) {
@@ -1183,7 +2396,7 @@ void PaceBms::write_charge_and_discharge_under_temperature_configuration_v25(Pac
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_mosfet_over_temperature_configuration_v25(PaceBmsProtocolV25::MosfetOverTemperatureConfiguration& config) {
@@ -1194,7 +2407,7 @@ void PaceBms::write_mosfet_over_temperature_configuration_v25(PaceBmsProtocolV25
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_environment_over_under_temperature_configuration_v25(PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration& config) {
@@ -1205,7 +2418,7 @@ void PaceBms::write_environment_over_under_temperature_configuration_v25(PaceBms
 	item->create_request_frame_ = [this, config](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteConfigurationRequest(this->address_, config, request); };
 	item->process_response_frame_ = [this, config](std::vector<uint8_t>& response) -> void { this->handle_write_configuration_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_system_datetime_v25(PaceBmsProtocolV25::DateTime& dt) {
@@ -1216,7 +2429,27 @@ void PaceBms::write_system_datetime_v25(PaceBmsProtocolV25::DateTime& dt) {
 	item->create_request_frame_ = [this, dt](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteSystemDateTimeRequest(this->address_, dt, request); };
 	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_write_system_datetime_response_v25(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
+}
+
+void PaceBms::write_charge_current_limiter_start_current_v25(uint8_t current) {
+	command_item* item = new command_item;
+
+	item->description_ = std::string("write charge current limiter start current");
+	ESP_LOGV(TAG, "Queueing write command '%s'", item->description_.c_str());
+	item->create_request_frame_ = [this, current](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateWriteChargeCurrentLimiterStartCurrentRequest(this->address_, current, request); };
+	item->process_response_frame_ = [this, current](std::vector<uint8_t>& response) -> void { this->handle_write_charge_current_limiter_start_current_response_v25(current, response); };
+	write_queue_push_back_with_deduplication(item);
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
+}
+
+// shared by the periodic configuration refresh and the read-back after a write
+PaceBms::command_item* PaceBms::create_read_charge_current_limiter_start_current_item_v25_() {
+	command_item* item = new command_item;
+	item->description_ = std::string("read charge current limiter start current");
+	item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v25_->CreateReadChargeCurrentLimiterStartCurrentRequest(this->address_, request); };
+	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_read_charge_current_limiter_start_current_response_v25(response); };
+	return item;
 }
 
 
@@ -1228,7 +2461,7 @@ void PaceBms::write_shutdown_v20() {
 	item->create_request_frame_ = [this](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateWriteShutdownCommandRequest(this->address_, request); };
 	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_write_shutdown_command_response_v20(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 void PaceBms::write_system_datetime_v20(PaceBmsProtocolV20::DateTime& dt) {
@@ -1239,7 +2472,7 @@ void PaceBms::write_system_datetime_v20(PaceBmsProtocolV20::DateTime& dt) {
 	item->create_request_frame_ = [this, dt](std::vector<uint8_t>& request) -> bool { return this->pace_bms_v20_->CreateWriteSystemDateTimeRequest(this->address_, dt, request); };
 	item->process_response_frame_ = [this](std::vector<uint8_t>& response) -> void { this->handle_write_system_datetime_response_v20(response); };
 	write_queue_push_back_with_deduplication(item);
-	ESP_LOGV(TAG, "Write commands queued: %i", write_queue_.size());
+	ESP_LOGV(TAG, "Write commands queued: %i", this->scheduler_.get_write_count());
 }
 
 }  // namespace pace_bms
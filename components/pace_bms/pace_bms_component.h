@@ -2,14 +2,22 @@
 
 #include <vector>
 #include <functional>
-#include <queue>
 #include <list>
+#include <queue>
 
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+#include "esphome/components/web_server_base/web_server_base.h"
+#endif
 
 #include "pace_bms_protocol_v25.h"
 #include "pace_bms_protocol_v20.h"
+#include "pace_bms_frame_capture.h"
+#include "pace_bms_proxy_cache.h"
+#include "pace_bms_scheduler.h"
 
 namespace esphome {
 namespace pace_bms {
@@ -20,19 +28,95 @@ namespace pace_bms {
 class PaceBms : public PollingComponent, public uart::UARTDevice {
 public:
 	// called by the codegen to set our YAML property values
-	void set_flow_control_pin(GPIOPin* flow_control_pin) { this->flow_control_pin_ = flow_control_pin; }
+	void set_flow_control_pin(GPIOPin* flow_control_pin) { this->primary_link_.flow_control_pin_ = flow_control_pin; }
+	// a second UART to the same pack, which carries the command classes added with add_secondary_uart_priority instead of the primary
+	void set_secondary_uart(uart::UARTComponent* secondary_uart);
+	void set_secondary_flow_control_pin(GPIOPin* flow_control_pin) { this->secondary_link_->flow_control_pin_ = flow_control_pin; }
+	void add_secondary_uart_priority(PaceBmsScheduler::Priority priority) { this->secondary_link_->priorities_ |= PaceBmsScheduler::priority_mask(priority); }
+	// a UART that other clients (PbmsTools, an inverter, another monitoring system) talk to as if it were the pack, see process_proxy_request_
+	void set_proxy_uart(uart::UARTComponent* proxy_uart);
+	void set_proxy_flow_control_pin(GPIOPin* flow_control_pin) { this->proxy_link_->flow_control_pin_ = flow_control_pin; }
+	void set_proxy_cache_ttl(uint32_t proxy_cache_ttl) { this->proxy_cache_ttl_ = proxy_cache_ttl; }
 	void set_address(uint8_t address) { this->address_ = address; }
 	void set_protocol_commandset(int protocol_commandset) { this->protocol_commandset_ = protocol_commandset; }
 	void set_protocol_variant(std::string protocol_variant) { this->protocol_variant_ = protocol_variant; }
 	void set_protocol_version(uint8_t protocol_version_override) { this->protocol_version_ = protocol_version_override; }
 	void set_chemistry(uint8_t chemistry) { this->chemistry_ = chemistry; }
+	void set_protocol_detect(bool protocol_detect) { this->protocol_detect_ = protocol_detect; }
 	void set_request_throttle(int request_throttle) { this->request_throttle_ = request_throttle; }
 	void set_response_timeout(int response_timeout) { this->response_timeout_ = response_timeout; }
+	void set_max_retries(uint8_t max_retries) { this->max_retries_ = max_retries; }
+	void set_retry_backoff(uint32_t retry_backoff) { this->retry_backoff_ = retry_backoff; }
+	void set_analog_information_interval(uint32_t analog_information_interval) { this->analog_information_interval_ = analog_information_interval; }
+	void set_configuration_interval(uint32_t configuration_interval) { this->configuration_interval_ = configuration_interval; }
+	void set_stale_timeout(uint32_t stale_timeout) { this->stale_timeout_ = stale_timeout; }
+	void set_offline_timeouts(uint8_t offline_timeouts) { this->offline_timeouts_ = offline_timeouts; }
+	void set_offline_max_interval(uint32_t offline_max_interval) { this->offline_max_interval_ = offline_max_interval; }
+	// candidates for the primary uart's baud rate, tried fastest first at startup, see loop_baud_rate_probe_
+	void add_baud_rate_probe(uint32_t baud_rate) { this->baud_rate_probe_.push_back(baud_rate); }
+	// never send anything, only decode the responses to another master's requests, see loop_listen_
+	void set_listen_only(bool listen_only) { this->listen_only_ = listen_only; }
+	void set_frame_capture_size(uint32_t frame_capture_size) { this->frame_capture_size_ = frame_capture_size; }
+#ifdef USE_ESP_IDF
+	void set_rx_pattern_detect(bool rx_pattern_detect) { this->rx_pattern_detect_ = rx_pattern_detect; }
+#endif
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+	void set_frame_capture_web_server(web_server_base::WebServerBase* web_server, const std::string& path);
+#endif
 
 	// make accessible to sensors
 	int get_protocol_commandset() { return this->protocol_commandset_; }
+	// zero means analog information is read every update, otherwise SoC and capacity are refreshed in between via read remaining capacity
+	uint32_t get_analog_information_interval() { return this->analog_information_interval_; }
+	// true while the pack isn't answering and is only being checked on now and then, see go_offline_
+	bool is_offline() { return this->offline_; }
 	void queue_sensor_update(std::function<void()> update) { this->sensor_update_queue_.push(update); }
 
+	// values that arrive together, for tracking how old what has been published is
+	enum DataGroup : uint8_t
+	{
+		DATA_GROUP_ANALOG_INFORMATION = 0,
+		DATA_GROUP_STATUS_INFORMATION = 1,
+		// any of the configuration reads, they're all refreshed together
+		DATA_GROUP_CONFIGURATION = 2,
+		DATA_GROUP_COUNT = 3,
+	};
+	// milliseconds since the last good response for this group, nullopt if there hasn't been one
+	OPTIONAL_NS::optional<uint32_t> get_data_age(DataGroup group);
+	// only the analog and status information go stale, and only with stale_timeout set
+	bool is_stale(DataGroup group) { return this->stale_[group]; }
+	static const char* get_data_group_name(DataGroup group);
+
+	// milliseconds any of this component's UARTs (or any on the whole node) have been busy since boot, for bus utilisation
+	uint64_t get_busy_time();
+	uint8_t get_link_count() { return this->secondary_link_ != nullptr ? 2 : 1; }
+	static uint64_t get_node_busy_time() { return node_busy_time_; }
+	static uint8_t get_node_link_count() { return node_link_count_; }
+
+	// since boot, across all of this component's UARTs
+	struct FailureCounts
+	{
+		// no complete response within response_timeout
+		uint32_t timeouts{ 0 };
+		// a response that failed its checksum, or was too long to be one
+		uint32_t corrupt_responses{ 0 };
+		// requests sent again after one of the above
+		uint32_t retries{ 0 };
+		// requests given up on once out of retries
+		uint32_t failed_requests{ 0 };
+	};
+	const FailureCounts& get_failure_counts() const { return this->failure_counts_; }
+
+	// raw frame capture, null unless frame_capture is configured in yaml
+	PaceBmsFrameCapture* get_frame_capture() { return this->frame_capture_; }
+	// logs every captured frame in the text format the replay tool reads, call it from a lambda (e.g. an api action)
+	void dump_frame_capture();
+
+	// sends a hardware version read to each address in turn with a short timeout to find which packs are on the bus, and a 
+	//     serial number read to each that answered, polling on the primary link is held off until it's done (about 2 
+	//     seconds) and then the result goes to the address scan callbacks
+	void start_address_scan();
+
 	// standard overrides to implement component behavior, update() queues periodic commands to request updates from the BMS
 	void dump_config() override;
 	void setup() override;
@@ -68,6 +152,17 @@ public:
 	void register_mosfet_over_temperature_configuration_callback_v25(std::function<void(PaceBmsProtocolV25::MosfetOverTemperatureConfiguration&)> callback) { mosfet_over_temperature_configuration_callbacks_v25_.push_back(std::move(callback)); }
 	void register_environment_over_under_temperature_configuration_callback_v25(std::function<void(PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration&)> callback) { environment_over_under_temperature_configuration_callbacks_v25_.push_back(std::move(callback)); }
 	void register_system_datetime_callback_v25(std::function<void(PaceBmsProtocolV25::DateTime&)> callback) { system_datetime_callbacks_v25_.push_back(std::move(callback)); }
+	void register_remaining_capacity_callback_v25(std::function<void(PaceBmsProtocolV25::RemainingCapacity&)> callback) { remaining_capacity_callbacks_v25_.push_back(std::move(callback)); }
+	void register_charge_current_limiter_start_current_callback_v25(std::function<void(uint8_t&)> callback) { charge_current_limiter_start_current_callbacks_v25_.push_back(std::move(callback)); }
+
+	// called every update() with the bus scheduler's statistics, for the diagnostic sensors
+	void register_scheduler_callback(std::function<void(const PaceBmsScheduler&)> callback) { scheduler_callbacks_.push_back(std::move(callback)); }
+	// called every update() with the age in milliseconds of each data group that has been received at least once
+	void register_data_age_callback(std::function<void(DataGroup, uint32_t)> callback) { data_age_callbacks_.push_back(std::move(callback)); }
+	// called once when a data group goes stale, the values published from it should be made unavailable until the next callback for that data arrives
+	void register_stale_callback(std::function<void(DataGroup)> callback) { stale_callbacks_.push_back(std::move(callback)); }
+	// called at the end of each address scan with the addresses that answered and their serial numbers
+	void register_address_scan_callback(std::function<void(std::string&)> callback) { address_scan_callbacks_.push_back(std::move(callback)); }
 	
 	void register_analog_information_callback_v20(std::function<void(PaceBmsProtocolV20::AnalogInformation&)> callback) { analog_information_callbacks_v20_.push_back(std::move(callback)); }
 	void register_status_information_callback_v20(std::function<void(PaceBmsProtocolV20::StatusInformation&)> callback) { status_information_callbacks_v20_.push_back(std::move(callback)); }
@@ -96,6 +191,7 @@ public:
 	void write_mosfet_over_temperature_configuration_v25(PaceBmsProtocolV25::MosfetOverTemperatureConfiguration& config);
 	void write_environment_over_under_temperature_configuration_v25(PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration& config);
 	void write_system_datetime_v25(PaceBmsProtocolV25::DateTime& dt);
+	void write_charge_current_limiter_start_current_v25(uint8_t current);
 
 	void write_shutdown_v20();
 	void write_system_datetime_v20(PaceBmsProtocolV20::DateTime& dt);
@@ -103,7 +199,6 @@ public:
 
 protected:
 	// config values set in YAML
-	GPIOPin* flow_control_pin_{ nullptr };
 	uint8_t address_{ 0 };
 
 	int protocol_commandset_{ 0 };
@@ -113,6 +208,50 @@ protected:
 
 	int request_throttle_{ 0 };
 	int response_timeout_{ 0 };
+	uint8_t max_retries_{ 0 };
+	uint32_t retry_backoff_{ 0 };
+	FailureCounts failure_counts_;
+	uint32_t analog_information_interval_{ 0 };
+	uint32_t configuration_interval_{ 0 };
+	uint32_t stale_timeout_{ 0 };
+	uint32_t frame_capture_size_{ 0 };
+
+	// when the full analog information was last queued, only used with analog_information_interval_
+	uint32_t last_analog_information_queued_{ 0 };
+	bool analog_information_queued_{ false };
+	// likewise for the configuration reads, only used with configuration_interval_
+	uint32_t last_configuration_queued_{ 0 };
+	bool configuration_queued_{ false };
+	bool is_due_(uint32_t interval, uint32_t last_queued, bool queued);
+
+	// when each data group last decoded successfully
+	uint32_t last_received_[DATA_GROUP_COUNT]{};
+	bool received_[DATA_GROUP_COUNT]{};
+	bool stale_[DATA_GROUP_COUNT]{};
+	void mark_received_(DataGroup group);
+	// dispatches stale_callbacks_ for anything that has just passed stale_timeout_
+	void check_stale_();
+	void mark_stale_(DataGroup group);
+
+	// after offline_timeouts_ timeouts in a row the pack is taken to be asleep or switched off, so rather than the whole read 
+	//     set timing out every update_interval it's only sent a hardware version read, at an interval that doubles each time 
+	//     up to offline_max_interval_, and the first good response from it brings full polling straight back
+	uint8_t offline_timeouts_{ 0 };
+	uint32_t offline_max_interval_{ 0 };
+	uint8_t consecutive_timeouts_{ 0 };
+	bool offline_{ false };
+	uint32_t offline_probe_interval_{ 0 };
+	uint32_t offline_probe_at_{ 0 };
+	// set when the pack answers again, so loop() calls update() once the response has been dealt with
+	bool resume_polling_{ false };
+	void go_offline_(uint32_t now);
+	void queue_offline_probe_(uint32_t now);
+
+	PaceBmsFrameCapture* frame_capture_{ nullptr };
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+	web_server_base::WebServerBase* frame_capture_web_server_{ nullptr };
+	std::string frame_capture_web_path_;
+#endif
 
 	// put into command_item as a pointer to handle the BMS response
 	void handle_read_analog_information_response_v25(std::vector<uint8_t>& response);
@@ -142,6 +281,9 @@ protected:
 	void handle_read_system_datetime_response_v25(std::vector<uint8_t>& response);
 	void handle_write_system_datetime_response_v25(std::vector<uint8_t>& response);
 	void handle_write_configuration_response_v25(std::vector<uint8_t>& response);
+	void handle_read_remaining_capacity_response_v25(std::vector<uint8_t>& response);
+	void handle_read_charge_current_limiter_start_current_response_v25(std::vector<uint8_t>& response);
+	void handle_write_charge_current_limiter_start_current_response_v25(uint8_t current, std::vector<uint8_t>& response);
 
 	void handle_read_analog_information_response_v20(std::vector<uint8_t>& response);
 	void handle_read_status_information_response_v20(std::vector<uint8_t>& response);
@@ -173,6 +315,8 @@ protected:
 	std::vector<std::function<void(PaceBmsProtocolV25::MosfetOverTemperatureConfiguration&)>>              mosfet_over_temperature_configuration_callbacks_v25_;
 	std::vector<std::function<void(PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration&)>>    environment_over_under_temperature_configuration_callbacks_v25_;
 	std::vector<std::function<void(PaceBmsProtocolV25::DateTime&)>>                                        system_datetime_callbacks_v25_;
+	std::vector<std::function<void(PaceBmsProtocolV25::RemainingCapacity&)>>                               remaining_capacity_callbacks_v25_;
+	std::vector<std::function<void(uint8_t&)>>                                                             charge_current_limiter_start_current_callbacks_v25_;
 
 	std::vector<std::function<void(PaceBmsProtocolV20::AnalogInformation&)>>                               analog_information_callbacks_v20_;
 	std::vector<std::function<void(PaceBmsProtocolV20::StatusInformation&)>>                               status_information_callbacks_v20_;
@@ -180,50 +324,212 @@ protected:
 	std::vector<std::function<void(std::string&)>>                                                 serial_number_callbacks_v20_;
 	std::vector<std::function<void(PaceBmsProtocolV20::DateTime&)>>                                        system_datetime_callbacks_v20_;
 
+	std::vector<std::function<void(const PaceBmsScheduler&)>>                                              scheduler_callbacks_;
+	std::vector<std::function<void(DataGroup, uint32_t)>>                                                  data_age_callbacks_;
+	std::vector<std::function<void(DataGroup)>>                                                            stale_callbacks_;
+	std::vector<std::function<void(std::string&)>>                                                         address_scan_callbacks_;
+
 	// along with loop() this is the "engine" of BMS communications
-	//     - send_next_request_frame_ will pop a command_item from the queue and dispatch a frame to the BMS
-	//     - process_response_frame_ will call next_response_handler_ (which was saved from the command_item popped in 
-	//           send_next_request_frame_) once a response arrives
-	PaceBmsProtocolV25* pace_bms_v25_;
-	PaceBmsProtocolV20* pace_bms_v20_;
+	//     - loop_link_ will pop a command_item from the scheduler and send_request_frame_ will dispatch a frame to the BMS
+	//     - process_response_frame_ will call link.next_response_handler_ (which was saved from the command_item popped in 
+	//           loop_link_) once a response arrives
+	PaceBmsProtocolV25* pace_bms_v25_{ nullptr };
+	PaceBmsProtocolV20* pace_bms_v20_{ nullptr };
+	// (re)creates whichever of the above protocol_commandset_ calls for with the current version and chemistry
+	void create_protocol_();
 	// this is currently "right sized" as it's only slightly larger than the largest 0x20 response I've seen
 	static const uint16_t max_data_len_ = 256;
-	uint8_t raw_data_[max_data_len_];
-	uint8_t raw_data_index_{ 0 };
-	uint32_t last_transmit_{ 0 };
-	uint32_t last_receive_{ 0 };
-	bool request_outstanding_ = false;
-	void send_next_request_frame_();
-	void process_response_frame_(uint8_t* frame_bytes, uint8_t frame_length);
-
-	// each item points to:
-	//     a description of what is happening such as "Read Analog Information" for logging purposes
-	//     a function pointer that will generate the request frame (to avoid holding the memory prior to it being required)
-	//     a function pointer that will process the response frame and dispatch the results to any child sensors registered via the callback vectors
-	struct command_item
+	// one request at a time per UART, each link has its own request outstanding, throttle, and receive buffer
+	struct link
 	{
-		std::string description_;
-		std::function<bool(std::vector<uint8_t>&)> create_request_frame_;
-		std::function<void(std::vector<uint8_t>&)> process_response_frame_;
+		const char* name_;
+		uart::UARTDevice* uart_{ nullptr };
+		uart::UARTComponent* component_{ nullptr };
+		GPIOPin* flow_control_pin_{ nullptr };
+		// which of the scheduler's priority classes go out over this link
+		uint8_t priorities_{ PaceBmsScheduler::ALL_PRIORITIES };
+		uint8_t raw_data_[max_data_len_];
+		uint8_t raw_data_index_{ 0 };
+		uint32_t last_transmit_{ 0 };
+		uint32_t last_receive_{ 0 };
+		bool request_outstanding_ = false;
+		// the command the outstanding request was made for, owned until the request is finished
+		PaceBmsScheduler::command_item* command_{ nullptr };
+		// a failed command waiting out its backoff to be sent again, ahead of anything queued
+		PaceBmsScheduler::command_item* retry_command_{ nullptr };
+		uint32_t retry_at_{ 0 };
+		std::function<void(std::vector<uint8_t>&)> next_response_handler_ = nullptr;
+		std::string request_description_;
+		// length and CHKSUM of the request last sent, to recognise it being echoed back, see is_request_echo_
+		uint16_t request_length_{ 0 };
+		uint8_t request_checksum_[4];
+		// only kept with a proxy configured, so the response can be cached against it
+		std::vector<uint8_t> request_frame_;
+		bool request_cacheable_{ false };
+		uint64_t busy_time_{ 0 };
+#ifdef USE_ESP_IDF
+		// the hardware UART number once rx pattern detect is enabled on it
+		int pattern_detect_uart_num_{ -1 };
+		size_t pattern_detect_available_{ 0 };
+#endif
+	};
+	// the primary link is the UART this component was configured with, the secondary link is optional
+	link primary_link_{ "primary", this };
+	link* secondary_link_{ nullptr };
+	// not a link to the pack at all, clients send requests here and get responses back, see process_proxy_request_
+	link* proxy_link_{ nullptr };
+	void loop_link_(link& link, uint32_t now, bool may_send);
+	void finish_request_(link& link, uint32_t now);
+	void abandon_request_(link& link, uint32_t now);
+	// whether the outstanding request on link counts toward going offline, and its answer toward coming back
+	static bool is_own_request_(const link& link);
+	void fail_request_(link& link, uint32_t now);
+	static bool is_request_echo_(const link& link, const uint8_t* frame_bytes, uint16_t frame_length);
+#ifdef USE_ESP_IDF
+	bool rx_pattern_detect_{ false };
+	// how many EOI positions the driver can hold, there's only ever meant to be one in the buffer
+	static const int pattern_queue_length_ = 4;
+	void enable_pattern_detect_(link& link, uart::UARTComponent* uart);
+	void receive_pattern_detect_(link& link, uint32_t now);
+#endif
+	// with baud_rate_probe_ set, nothing but a hardware version read goes out on the primary link at each candidate in
+	//     turn until one comes back cleanly (or they all fail and the uart's configured rate is restored), index is -1 once done
+	std::vector<uint32_t> baud_rate_probe_;
+	int8_t baud_rate_probe_index_{ -1 };
+	bool baud_rate_probe_sent_{ false };
+	bool baud_rate_probe_answered_{ false };
+	uint32_t configured_baud_rate_{ 0 };
+	void loop_baud_rate_probe_(uint32_t now);
+	void finish_baud_rate_probe_();
+	void set_baud_rate_(uint32_t baud_rate);
+	// with protocol_detect_ set, once the baud rate probe (if any) is done the same hardware version read goes out with each 
+	//     plausible protocol version and chemistry in turn until one decodes, whatever was found is saved to flash and tried 
+	//     first on the next boot, so normally that's the only request it takes, index is -1 once done
+	struct protocol_settings
+	{
+		uint8_t commandset_;
+		uint8_t version_;
+		uint8_t chemistry_;
 	};
-	// when the bus is clear:
-	//     the next command_item will be popped from either the read or the write queue (writes always take priority)
+	bool protocol_detect_{ false };
+	std::vector<protocol_settings> protocol_detect_candidates_;
+	protocol_settings protocol_detect_configured_;
+	int8_t protocol_detect_index_{ -1 };
+	bool protocol_detect_sent_{ false };
+	bool protocol_detect_answered_{ false };
+	// the VER and CID1 from the header of a response that didn't decode, which is usually the pack saying what it does speak
+	OPTIONAL_NS::optional<protocol_settings> protocol_detect_heard_;
+	ESPPreferenceObject protocol_detect_preference_;
+	void start_protocol_detect_();
+	void loop_protocol_detect_(uint32_t now);
+	void handle_protocol_detect_response_(bool decoded, std::vector<uint8_t>& response);
+	void apply_protocol_settings_(const protocol_settings& settings);
+	void finish_protocol_detect_();
+	// while scanning, the next address is probed as soon as the last one answers or goes quiet for address_scan_timeout_, 
+	//     which is far shorter than response_timeout since an absent pack is the usual case, index is -1 when not scanning
+	static const uint8_t address_scan_count_ = 16;
+	static const uint32_t address_scan_timeout_ = 100;
+	int8_t address_scan_address_{ -1 };
+	bool address_scan_sent_{ false };
+	// whether the current address answered the hardware version probe, and whether it's been asked for its serial number since
+	bool address_scan_answered_{ false };
+	bool address_scan_serial_number_sent_{ false };
+	std::string address_scan_serial_number_;
+	std::string address_scan_result_;
+	void loop_address_scan_(uint32_t now);
+	// summed across every PaceBms instance, each hub's loop() services only its own links but they all share one main loop
+	static uint64_t node_busy_time_;
+	static uint8_t node_link_count_;
+
+	// see PaceBmsScheduler for what each item holds
+	typedef PaceBmsScheduler::command_item command_item;
+	// when a link is clear:
+	//     the scheduler picks the next command_item among the classes that link carries, see PaceBmsScheduler for how
 	//     the request frame generated and dispatched via command_item.create_request_frame_
-	//     the expected response handler (command_item.process_response_frame_) will be assigned to next_response_handler_ to be called once a response frame arrives
-	//     last_request_description is also saved for logging purposes as:
+	//     the expected response handler (command_item.process_response_frame_) will be assigned to link.next_response_handler_ to be called once a response frame arrives
+	//     link.request_description_ is also saved for logging purposes as:
 	//     once this sequence starts, the command_item is thrown away - it's all bytes and saved pointers from this point
 	//         see section: "along with loop() this is the "engine" of BMS communications" for how this works
-	// commands generated as a result of user interaction are pushed to the write queue which has priority over the read queue
-	// the read queue is filled each update() with only the commands necessary to refresh child components that have been declared in the yaml config and requested a callback for the information
+	// commands generated as a result of user interaction are queued as writes, which should go out promptly but can't hold off the protection reads
+	// reads are queued each update() with only the commands necessary to refresh child components that have been declared in the yaml config and requested a callback for the information
 	std::queue<std::function<void()>> sensor_update_queue_;
-	std::queue<command_item*> read_queue_;
-	std::list<command_item*> write_queue_;
-	std::function<void(std::vector<uint8_t>&)> next_response_handler_ = nullptr;
+	PaceBmsScheduler scheduler_;
+	// whichever request the response currently being handled is for, for logging
 	std::string last_request_description;
+	// false (with command deleted) if the request frame couldn't be created, in which case nothing was written
+	bool send_request_frame_(link& link, command_item* command);
+	// sends command and marks link as waiting for the response, unless nothing could be sent
+	void start_request_(link& link, command_item* command, uint32_t now);
+	// false if the frame was damaged on the way, in which case the response handler isn't called
+	bool process_response_frame_(link& link, uint8_t* frame_bytes, uint16_t frame_length);
+	// writes a whole frame out, with flow control if the link has it
+	void write_frame_(link& link, const uint8_t* frame_bytes, size_t frame_length);
+	// reads whatever has arrived on a link that isn't waiting on a request of its own, and calls handler with each whole frame
+	typedef void (PaceBms::*frame_handler)(link& link, uint8_t* frame_bytes, uint16_t frame_length, uint32_t now);
+	void receive_frames_(link& link, uint32_t now, frame_handler handler);
 
+	// how long a user initiated write may wait for the bus
+	static const uint32_t write_deadline_ = 2000;
+	// queues a read with a deadline of its refresh period
+	void queue_read_(command_item* item, PaceBmsScheduler::Priority priority);
+	// true if a command with this description is queued, in flight, or waiting out a retry backoff on either link
+	bool is_read_pending_(const std::string& description);
+	// a read's request frame only depends on the address and protocol settings, so each one is built the first time it's 
+	//     queued and sent as is from then on, a list so the frames never move once an item points at one
+	struct read_request_frame
+	{
+		std::string description_;
+		std::vector<uint8_t> frame_;
+	};
+	std::list<read_request_frame> read_request_frames_;
+	const std::vector<uint8_t>* get_read_request_frame_(command_item* item);
+
+	// with listen_only_ set the reads update() would have queued are kept here instead, along with the ADR and CID2 of the 
+	//     request frame they would have sent, so the same request from another master can be recognised
+	struct listened_read
+	{
+		uint8_t address_;
+		uint8_t cid2_;
+		command_item* command_;
+	};
+	bool listen_only_{ false };
+	std::vector<listened_read> listened_reads_;
+	// ADR of the last request heard, its response comes from the same address
+	uint8_t listened_request_address_{ 0 };
+	void listen_for_read_(command_item* item);
+	void loop_listen_(uint32_t now);
+	void process_listened_frame_(link& link, uint8_t* frame_bytes, uint16_t frame_length, uint32_t now);
+
+	PaceBmsProxyCache proxy_cache_;
+	// 0 means twice update_interval
+	uint32_t proxy_cache_ttl_{ 0 };
+	void cache_response_(link& link, const uint8_t* frame_bytes, uint16_t frame_length);
+	void process_proxy_request_(link& link, uint8_t* frame_bytes, uint16_t frame_length, uint32_t now);
+	// a single hex encoded byte, or -1 if either character isn't hex
+	static int16_t decode_hex_byte_(const uint8_t* hex);
 	// helper to avoid pushing redundant write requests
 	void write_queue_push_back_with_deduplication(command_item* item);
+	// queues the configuration reads that are only refreshed every configuration_interval_
+	void queue_configuration_reads_v25_();
+	command_item* create_read_charge_current_limiter_start_current_item_v25_();
+};
+
+#ifdef USE_PACE_BMS_FRAME_CAPTURE_WEB
+// serves the frame capture as a pcap download from the web server
+class PaceBmsFrameCaptureHandler : public AsyncWebHandler {
+public:
+	PaceBmsFrameCaptureHandler(PaceBmsFrameCapture* capture, const std::string& path) : capture_(capture), path_(path) {}
+
+	bool canHandle(AsyncWebServerRequest* request) override { return request->method() == HTTP_GET && request->url() == this->path_.c_str(); }
+	void handleRequest(AsyncWebServerRequest* request) override;
+
+protected:
+	PaceBmsFrameCapture* capture_;
+	std::string path_;
+	// the response is sent asynchronously straight out of this buffer, so it has to outlive handleRequest
+	std::vector<uint8_t> pcap_;
 };
+#endif
 
 }  // namespace pace_bms
 }  // namespace esphome
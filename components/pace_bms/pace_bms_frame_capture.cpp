@@ -0,0 +1,115 @@
+#include <cstring>
+
+#include "pace_bms_frame_capture.h"
+
+namespace esphome {
+namespace pace_bms {
+
+void PaceBmsFrameCapture::allocate(size_t size) {
+	delete[] this->buffer_;
+	this->buffer_ = new uint8_t[size];
+	this->capacity_ = size;
+	this->clear();
+}
+
+void PaceBmsFrameCapture::clear() {
+	this->head_ = 0;
+	this->tail_ = 0;
+	this->used_ = 0;
+	this->record_count_ = 0;
+	this->dropped_count_ = 0;
+}
+
+void PaceBmsFrameCapture::record(RecordType type, uint32_t timestamp, const uint8_t* data, uint16_t length) {
+	size_t total = RECORD_HEADER_SIZE + length;
+	if (this->buffer_ == nullptr || total > this->capacity_) {
+		this->dropped_count_++;
+		return;
+	}
+
+	// make room by throwing away the oldest records
+	while (this->used_ + total > this->capacity_) {
+		size_t oldest = RECORD_HEADER_SIZE + this->get_record_length_(this->tail_);
+		this->tail_ = (this->tail_ + oldest) % this->capacity_;
+		this->used_ -= oldest;
+		this->record_count_--;
+		this->dropped_count_++;
+	}
+
+	uint8_t header[RECORD_HEADER_SIZE] = {
+		(uint8_t) timestamp, (uint8_t) (timestamp >> 8), (uint8_t) (timestamp >> 16), (uint8_t) (timestamp >> 24),
+		type,
+		(uint8_t) length, (uint8_t) (length >> 8),
+	};
+	this->put_(header, RECORD_HEADER_SIZE);
+	this->put_(data, length);
+	this->used_ += total;
+	this->record_count_++;
+}
+
+void PaceBmsFrameCapture::put_(const uint8_t* data, size_t length) {
+	size_t first = this->capacity_ - this->head_;
+	if (first > length)
+		first = length;
+	memcpy(this->buffer_ + this->head_, data, first);
+	memcpy(this->buffer_, data + first, length - first);
+	this->head_ = (this->head_ + length) % this->capacity_;
+}
+
+void PaceBmsFrameCapture::get_(size_t position, uint8_t* data, size_t length) const {
+	size_t first = this->capacity_ - position;
+	if (first > length)
+		first = length;
+	memcpy(data, this->buffer_ + position, first);
+	memcpy(data + first, this->buffer_, length - first);
+}
+
+uint16_t PaceBmsFrameCapture::get_record_length_(size_t position) const {
+	uint8_t length[2];
+	this->get_((position + 5) % this->capacity_, length, 2);
+	return length[0] | (length[1] << 8);
+}
+
+static void append_u16(std::vector<uint8_t>& out, uint16_t value) {
+	out.push_back(value & 0xFF);
+	out.push_back(value >> 8);
+}
+
+static void append_u32(std::vector<uint8_t>& out, uint32_t value) {
+	append_u16(out, value & 0xFFFF);
+	append_u16(out, value >> 16);
+}
+
+void PaceBmsFrameCapture::write_pcap(std::vector<uint8_t>& out) const {
+	out.clear();
+	out.reserve(24 + this->used_ + this->record_count_ * (16 + 1 - RECORD_HEADER_SIZE));
+
+	// global header, little endian, microsecond timestamps
+	append_u32(out, 0xA1B2C3D4);
+	append_u16(out, 2);
+	append_u16(out, 4);
+	append_u32(out, 0);
+	append_u32(out, 0);
+	append_u32(out, 65535);
+	append_u32(out, PCAP_LINKTYPE_USER0);
+
+	bool first = true;
+	uint32_t previous = 0;
+	uint64_t elapsed = 0;
+	this->for_each([&](RecordType type, uint32_t timestamp, const std::vector<uint8_t>& data) {
+		if (!first)
+			elapsed += (uint32_t) (timestamp - previous);
+		first = false;
+		previous = timestamp;
+
+		append_u32(out, (uint32_t) (elapsed / 1000000));
+		append_u32(out, (uint32_t) (elapsed % 1000000));
+		append_u32(out, data.size() + 1);
+		append_u32(out, data.size() + 1);
+		out.push_back(type);
+		out.insert(out.end(), data.begin(), data.end());
+	});
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace pace_bms {
+
+/*
+* Binary ring buffer of raw request/response frames with microsecond timestamps.
+*
+* Recording is a couple of memcpy's into a buffer allocated once at setup, there's no formatting and no allocation, so
+* it can be left on while the bus is running normally.  When the buffer fills up the oldest frames are dropped.
+*
+* Each record is stored as:
+*   uint32_t timestamp  micros() when the frame was sent / finished arriving, little endian
+*   uint8_t  type       see RecordType
+*   uint16_t length     little endian
+*   uint8_t  data[length]
+*
+* The capture can be exported as a pcap file (link type USER0) where every packet is the one byte record type followed
+* by the frame.  micros() wraps every ~71 minutes so timestamps are exported relative to the first record by summing
+* the (unsigned, wrap-safe) deltas between records.
+*
+* This has no esphome dependencies so the offline replay tool can use the same definitions.
+*/
+class PaceBmsFrameCapture {
+public:
+	enum RecordType : uint8_t
+	{
+		// a request frame we sent
+		RECORD_REQUEST = 'T',
+		// a complete response frame, through EOI
+		RECORD_RESPONSE = 'R',
+		// whatever arrived before we gave up on a response: timeout, bad SOI, or too long
+		RECORD_ABANDONED = 'P',
+	};
+
+	static const uint8_t RECORD_HEADER_SIZE = 7;
+	static const uint32_t PCAP_LINKTYPE_USER0 = 147;
+
+	~PaceBmsFrameCapture() { delete[] this->buffer_; }
+
+	// allocates the ring buffer, anything previously recorded is discarded
+	void allocate(size_t size);
+	size_t get_capacity() const { return this->capacity_; }
+
+	void record(RecordType type, uint32_t timestamp, const uint8_t* data, uint16_t length);
+	void clear();
+
+	uint32_t get_record_count() const { return this->record_count_; }
+	uint32_t get_dropped_count() const { return this->dropped_count_; }
+
+	// calls back for every record still in the buffer, oldest first
+	template <typename Callback>
+	void for_each(Callback callback) const;
+
+	// the whole buffer as a pcap file
+	void write_pcap(std::vector<uint8_t>& out) const;
+
+protected:
+	uint8_t* buffer_{ nullptr };
+	size_t capacity_{ 0 };
+	// oldest record starts at tail_, next record will be written at head_
+	size_t head_{ 0 };
+	size_t tail_{ 0 };
+	size_t used_{ 0 };
+	uint32_t record_count_{ 0 };
+	uint32_t dropped_count_{ 0 };
+
+	void put_(const uint8_t* data, size_t length);
+	void get_(size_t position, uint8_t* data, size_t length) const;
+	uint16_t get_record_length_(size_t position) const;
+};
+
+template <typename Callback>
+void PaceBmsFrameCapture::for_each(Callback callback) const {
+	std::vector<uint8_t> data;
+	size_t position = this->tail_;
+	for (uint32_t i = 0; i < this->record_count_; i++) {
+		uint8_t header[RECORD_HEADER_SIZE];
+		this->get_(position, header, RECORD_HEADER_SIZE);
+		uint32_t timestamp = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t) header[3] << 24);
+		uint16_t length = header[5] | (header[6] << 8);
+		data.resize(length);
+		this->get_((position + RECORD_HEADER_SIZE) % this->capacity_, data.data(), length);
+		callback((RecordType) header[4], timestamp, data);
+		position = (position + RECORD_HEADER_SIZE + length) % this->capacity_;
+	}
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -1,48 +1,67 @@
 
 #include "pace_bms_protocol_base.h"
 
-void PaceBmsProtocolBase::LogError(std::string message)
+void PaceBmsProtocolBase::Log(LogLevel level, const char* format, va_list args)
 {
-	if (LogErrorPtr != 0)
+	if (LogPtr != 0)
 	{
-		LogErrorPtr(message);
+		LogPtr(level, format, args);
 	}
 }
-void PaceBmsProtocolBase::LogWarning(std::string message)
+#if PACE_BMS_LOG_LEVEL >= 1
+void PaceBmsProtocolBase::LogError(const char* format, ...)
 {
-	if (LogWarningPtr != 0)
-	{
-		LogWarningPtr(message);
-	}
+	va_list args;
+	va_start(args, format);
+	Log(LL_Error, format, args);
+	va_end(args);
 }
-void PaceBmsProtocolBase::LogInfo(std::string message)
+#endif
+#if PACE_BMS_LOG_LEVEL >= 2
+void PaceBmsProtocolBase::LogWarning(const char* format, ...)
 {
-	if (LogInfoPtr != 0)
-	{
-		LogInfoPtr(message);
-	}
+	va_list args;
+	va_start(args, format);
+	Log(LL_Warning, format, args);
+	va_end(args);
 }
-void PaceBmsProtocolBase::LogDebug(std::string message)
+#endif
+#if PACE_BMS_LOG_LEVEL >= 3
+void PaceBmsProtocolBase::LogInfo(const char* format, ...)
 {
-	if (LogDebugPtr != 0)
-	{
-		LogDebugPtr(message);
-	}
+	va_list args;
+	va_start(args, format);
+	Log(LL_Info, format, args);
+	va_end(args);
 }
-void PaceBmsProtocolBase::LogVerbose(std::string message)
+#endif
+#if PACE_BMS_LOG_LEVEL >= 5
+void PaceBmsProtocolBase::LogDebug(const char* format, ...)
 {
-	if (LogVerbosePtr != 0)
-	{
-		LogVerbosePtr(message);
-	}
+	va_list args;
+	va_start(args, format);
+	Log(LL_Debug, format, args);
+	va_end(args);
 }
-void PaceBmsProtocolBase::LogVeryVerbose(std::string message)
+#endif
+#if PACE_BMS_LOG_LEVEL >= 6
+void PaceBmsProtocolBase::LogVerbose(const char* format, ...)
 {
-	if (LogVeryVerbosePtr != 0)
-	{
-		LogVeryVerbosePtr(message);
-	}
+	va_list args;
+	va_start(args, format);
+	Log(LL_Verbose, format, args);
+	va_end(args);
+}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 7
+void PaceBmsProtocolBase::LogVeryVerbose(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	Log(LL_VeryVerbose, format, args);
+	va_end(args);
 }
+#endif
 
 // Takes a length value and adds a checksum to the upper nibble, this is "CKLEN" used in command or response headers
 uint16_t PaceBmsProtocolBase::CreateChecksummedLength(const uint16_t cklen)
@@ -104,6 +123,16 @@ uint16_t PaceBmsProtocolBase::CalculateRequestOrResponseChecksum(const std::vect
 	return (uint16_t)cksum;
 }
 
+bool PaceBmsProtocolBase::ValidateResponseChecksum(const std::vector<uint8_t>& response)
+{
+	if (response.size() < 18)
+		return false;
+
+	uint16_t byteOffset = (uint16_t)response.size() - 5;
+	uint16_t givenCksum = ReadHexEncodedUShort(response, byteOffset);
+	return givenCksum == CalculateRequestOrResponseChecksum(response);
+}
+
 // helper for WriteHexEncoded----
 uint8_t PaceBmsProtocolBase::NibbleToHex(const uint8_t nibbleByte)
 {
@@ -137,7 +166,7 @@ uint8_t PaceBmsProtocolBase::HexToNibble(const uint8_t hex)
 // decode a 'real' byte from the stream by reading two ASCII hex encoded bytes
 uint8_t PaceBmsProtocolBase::ReadHexEncodedByte(const std::vector<uint8_t>& data, uint16_t& dataOffset)
 {
-	if (data.size() - dataOffset < 2)
+	if ((size_t)dataOffset + 2 > data.size())
 	{
 		LogError("Attempt to read past end of array");
 		return 0;
@@ -151,7 +180,7 @@ uint8_t PaceBmsProtocolBase::ReadHexEncodedByte(const std::vector<uint8_t>& data
 // decode a 'real' uint16_t from the stream by reading four ASCII hex encoded bytes
 uint16_t PaceBmsProtocolBase::ReadHexEncodedUShort(const std::vector<uint8_t>& data, uint16_t& dataOffset)
 {
-	if (data.size() - dataOffset < 4)
+	if ((size_t)dataOffset + 4 > data.size())
 	{
 		LogError("Attempt to read past end of array");
 		return 0;
@@ -167,7 +196,7 @@ uint16_t PaceBmsProtocolBase::ReadHexEncodedUShort(const std::vector<uint8_t>& d
 // decode a 'real' int16_t from the stream by reading four ASCII hex encoded bytes
 int16_t PaceBmsProtocolBase::ReadHexEncodedSShort(const std::vector<uint8_t>& data, uint16_t& dataOffset)
 {
-	if (data.size() - dataOffset < 4)
+	if ((size_t)dataOffset + 4 > data.size())
 	{
 		LogError("Attempt to read past end of array");
 		return 0;
@@ -183,27 +212,27 @@ int16_t PaceBmsProtocolBase::ReadHexEncodedSShort(const std::vector<uint8_t>& da
 // decode a 'real' uint32_t from the stream by reading four ASCII hex encoded bytes
 uint32_t PaceBmsProtocolBase::ReadHexEncodedULong(const std::vector<uint8_t>& data, uint16_t& dataOffset)
 {
-	if (data.size() - dataOffset < 8)
+	if ((size_t)dataOffset + 8 > data.size())
 	{
 		LogError("Attempt to read past end of array");
 		return 0;
 	}
 	uint32_t ulong = 0;
-	ulong |= ((HexToNibble(data[dataOffset++]) << 28) & 0xF0000000);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 24) & 0x0F000000);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 20) & 0x00F00000);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 16) & 0x000F0000);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 12) & 0x0000F000);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 8)  & 0x00000F00);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 4)  & 0x000000F0);
-	ulong |= ((HexToNibble(data[dataOffset++]) << 0)  & 0x0000000F);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 28) & 0xF0000000);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 24) & 0x0F000000);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 20) & 0x00F00000);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 16) & 0x000F0000);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 12) & 0x0000F000);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 8)  & 0x00000F00);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 4)  & 0x000000F0);
+	ulong |= (((uint32_t)HexToNibble(data[dataOffset++]) << 0)  & 0x0000000F);
 	return ulong;
 }
 
 // encode a 'real' byte to the stream by writing two ASCII hex encoded bytes
 void PaceBmsProtocolBase::WriteHexEncodedByte(std::vector<uint8_t>& data, uint16_t& dataOffset, uint8_t byte)
 {
-	if (data.size() - dataOffset < 2)
+	if ((size_t)dataOffset + 2 > data.size())
 	{
 		LogError("Attempt to write past end of array");
 		return;
@@ -215,7 +244,7 @@ void PaceBmsProtocolBase::WriteHexEncodedByte(std::vector<uint8_t>& data, uint16
 // encode a 'real' uint16_t to the stream by writing four ASCII hex encoded bytes
 void PaceBmsProtocolBase::WriteHexEncodedUShort(std::vector<uint8_t>& data, uint16_t& dataOffset, uint16_t ushort)
 {
-	if (data.size() - dataOffset < 4)
+	if ((size_t)dataOffset + 4 > data.size())
 	{
 		LogError("Attempt to write past end of array");
 		return;
@@ -229,7 +258,7 @@ void PaceBmsProtocolBase::WriteHexEncodedUShort(std::vector<uint8_t>& data, uint
 // encode a 'real' int16_t to the stream by writing four ASCII hex encoded bytes
 void PaceBmsProtocolBase::WriteHexEncodedSShort(std::vector<uint8_t>& data, uint16_t& dataOffset, int16_t sshort)
 {
-	if (data.size() - dataOffset < 4)
+	if ((size_t)dataOffset + 4 > data.size())
 	{
 		LogError("Attempt to write past end of array");
 		return;
@@ -240,65 +269,112 @@ void PaceBmsProtocolBase::WriteHexEncodedSShort(std::vector<uint8_t>& data, uint
 	data[dataOffset++] = NibbleToHex((sshort >> 0) & 0x0F);
 }
 
-std::string PaceBmsProtocolBase::FormatReturnCode(const uint8_t returnCode)
+const char* PaceBmsProtocolBase::FormatReturnCode(const uint8_t returnCode)
 {
 	switch (returnCode)
 	{
 	case 0x00:
-		return std::string("OK");
+		return "OK";
 		break;
 	case 0x01:
-		return std::string("Version Error");
+		return "Version Error";
 		break;
 	case 0x02:
-		return std::string("CKSUM Error (full request checksum)");
+		return "CKSUM Error (full request checksum)";
 		break;
 	case 0x03:
-		return std::string("LCKSUM Error (checksum of embedded payload length value)");
+		return "LCKSUM Error (checksum of embedded payload length value)";
 		break;
 	case 0x04:
-		return std::string("CID2 Undefined (unknown command)");
+		return "CID2 Undefined (unknown command)";
 		break;
 	case 0x05:
-		return std::string("Command Format Error");
+		return "Command Format Error";
 		break;
 	case 0x06:
-		return std::string("Invalid Data");
+		return "Invalid Data";
 		break;
 	case 0x07:
-		return std::string("No Data (historical record)");
+		return "No Data (historical record)";
 		break;
 	case 0x09:
-		return std::string("Operation or Write Error");
+		return "Operation or Write Error";
 		break;
 	case 0x90:
-		return std::string("ADR Error");
+		return "ADR Error";
 		break;
 	case 0x91:
-		return std::string("Communication Error");
+		return "Communication Error";
 		break;
 	case 0xE1:
-		return std::string("CID1 Error (battery chemistry)");
+		return "CID1 Error (battery chemistry)";
 		break;
 	case 0xE2:
-		return std::string("Command Execution Failed");
+		return "Command Execution Failed";
 		break;
 	case 0xE3:
-		return std::string("Equipment Failure");
+		return "Equipment Failure";
 		break;
 	case 0xE4:
-		return std::string("Invalid Permission");
+		return "Invalid Permission";
 		break;
 	default:
-		return std::string("Undocumented Response Error Code");
+		return "Undocumented Response Error Code";
 		break;
 	}
 
-	return std::string("impossible");
+	return "impossible";
+}
+
+uint16_t PaceBmsProtocolBase::CalculateHundredthsPercent(const uint32_t numerator, const uint32_t denominator)
+{
+	if (denominator == 0)
+		return 0;
+
+	uint64_t result = ((uint64_t)numerator * 10000) / denominator;
+	if (result > 65535)
+		return 65535;
+	return (uint16_t)result;
+}
+
+int32_t PaceBmsProtocolBase::CalculatePowerMilliwatts(const uint16_t totalVoltageMillivolts, const int32_t currentMilliamps)
+{
+	return (int32_t)(((int64_t)totalVoltageMillivolts * currentMilliamps) / 1000);
+}
+
+void PaceBmsProtocolBase::CalculateCellVoltageStatistics(const uint16_t* cellVoltagesMillivolts, const uint8_t cellCount,
+	uint16_t& minCellVoltageMillivolts, uint16_t& maxCellVoltageMillivolts, uint16_t& avgCellVoltageMillivolts, uint16_t& maxCellDifferentialMillivolts)
+{
+	if (cellCount == 0)
+	{
+		minCellVoltageMillivolts = 0;
+		maxCellVoltageMillivolts = 0;
+		avgCellVoltageMillivolts = 0;
+		maxCellDifferentialMillivolts = 0;
+		return;
+	}
+
+	// branchless min/max and a 32 bit sum, the 16 bit sum used previously would overflow with 16 cells above ~4.1v
+	// this is a simple enough loop for the compiler to unroll / vectorize where the target supports it
+	uint16_t minimum = 65535;
+	uint16_t maximum = 0;
+	uint32_t sum = 0;
+	for (int i = 0; i < cellCount; i++)
+	{
+		uint16_t cell = cellVoltagesMillivolts[i];
+		minimum = cell < minimum ? cell : minimum;
+		maximum = cell > maximum ? cell : maximum;
+		sum += cell;
+	}
+
+	minCellVoltageMillivolts = minimum;
+	maxCellVoltageMillivolts = maximum;
+	avgCellVoltageMillivolts = (uint16_t)(sum / cellCount);
+	maxCellDifferentialMillivolts = maximum - minimum;
 }
 
 // create a standard request to the given busId for the given CID2, filling in the payload (if given)
-void PaceBmsProtocolBase::CreateRequest(const uint8_t busId, const uint8_t cid2, const std::vector<uint8_t> payload, std::vector<uint8_t>& request)
+void PaceBmsProtocolBase::CreateRequest(const uint8_t busId, const uint8_t cid2, const std::vector<uint8_t>& payload, std::vector<uint8_t>& request)
 {
 	uint16_t byteOffset = 0;
 
@@ -345,7 +421,7 @@ void PaceBmsProtocolBase::CreateRequest(const uint8_t busId, const uint8_t cid2,
 
 // validate all fields in the response except the payload data: SOI marker, header values, checksum, EOI marker
 // returns the detected payload length (payload always starts at offset 13), or -1 for error
-int16_t PaceBmsProtocolBase::ValidateResponseAndGetPayloadLength(const uint8_t busId, const std::vector<uint8_t> response)
+int16_t PaceBmsProtocolBase::ValidateResponseAndGetPayloadLength(const uint8_t busId, const std::vector<uint8_t>& response)
 {
 	uint16_t byteOffset = 0;
 
@@ -395,7 +471,7 @@ int16_t PaceBmsProtocolBase::ValidateResponseAndGetPayloadLength(const uint8_t b
 	uint8_t returnCode = ReadHexEncodedByte(response, byteOffset);
 	if (returnCode != 0)
 	{
-		LogError(std::string("Error code returned by device: ") + FormatReturnCode(returnCode));
+		LogError("Error code returned by device: %s", FormatReturnCode(returnCode));
 		return -1;
 	}
 
@@ -418,12 +494,12 @@ int16_t PaceBmsProtocolBase::ValidateResponseAndGetPayloadLength(const uint8_t b
 	////}
 
 	// check payload length
-	if ((uint16_t)response.size() < payloadLen + 18)
+	if (response.size() < (size_t)payloadLen + 18)
 	{
 		LogError("Response is truncated, should be 18 bytes + decoded payload length");
 		return -1;
 	}
-	if ((uint16_t)response.size() > payloadLen + 18)
+	if (response.size() > (size_t)payloadLen + 18)
 	{
 		LogError("Response is oversize");
 		return -1;
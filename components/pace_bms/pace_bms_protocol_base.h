@@ -1,13 +1,30 @@
 #pragma once
 
+#include <cstdarg>
 #include <string>
 #include <vector>
 
-// uncomment the std version if using a C++17 compiler, otherwise esphome provides an equivalent implementation
+// define PACE_BMS_USE_STD_OPTIONAL if using a C++17 compiler outside of esphome (the fuzzer does), otherwise esphome provides an equivalent implementation
+#ifdef PACE_BMS_USE_STD_OPTIONAL
+#include <optional>
+#define OPTIONAL_NS std
+#else
 #include "esphome/core/optional.h"
 #define OPTIONAL_NS esphome
-//#include <optional>
-//#define OPTIONAL_NS std
+#endif
+
+// compile-time minimum log level, using the LogLevel values below
+// anything less severe than this is compiled out entirely, along with the formatting of its arguments
+// inside esphome the component passes the logger's level in as a build flag, otherwise everything is compiled in unless told otherwise
+#ifndef PACE_BMS_LOG_LEVEL
+#define PACE_BMS_LOG_LEVEL 7
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PACE_BMS_LOG_FORMAT __attribute__((format(printf, 2, 3)))
+#else
+#define PACE_BMS_LOG_FORMAT
+#endif
 
 /*
 General format of requests/responses:
@@ -31,11 +48,23 @@ offset LENID+17, 1 byte,   binary    0x0D:   EOI          - end of information '
 class PaceBmsProtocolBase
 {
 public:
+	// numbered the same as ESPHOME_LOG_LEVEL_* so esphome can pass them straight through
+	enum LogLevel : uint8_t
+	{
+		LL_Error = 1,
+		LL_Warning = 2,
+		LL_Info = 3,
+		LL_Debug = 5,
+		LL_Verbose = 6,
+		LL_VeryVerbose = 7,
+	};
+
 	// dependency injection
-	typedef void (*LogFuncPtr)(std::string message);
+	// printf style so nothing gets formatted unless it's actually going to be logged, and then straight into the log buffer
+	typedef void (*LogFuncPtr)(LogLevel level, const char* format, va_list args);
 
 	PaceBmsProtocolBase(uint8_t protocol_commandset, OPTIONAL_NS::optional<std::string> protocol_variant, OPTIONAL_NS::optional<uint8_t> protocol_version, OPTIONAL_NS::optional<uint8_t> battery_chemistry,
-		                LogFuncPtr logError, LogFuncPtr logWarning, LogFuncPtr logInfo, LogFuncPtr logDebug, LogFuncPtr logVerbose, LogFuncPtr logVeryVerbose)
+		                LogFuncPtr log)
 	{
 		this->protocol_commandset = protocol_commandset;
 		this->protocol_variant = protocol_variant;
@@ -45,14 +74,13 @@ public:
 		else
 			this->cid1 = 0x46;
 
-		this->LogErrorPtr = logError;
-		this->LogWarningPtr = logWarning;
-		this->LogInfoPtr = logInfo;
-		this->LogDebugPtr = logDebug;
-		this->LogVerbosePtr = logVerbose;
-		this->LogVeryVerbosePtr = logVeryVerbose;
+		this->LogPtr = log;
 	}
 
+	// true if the frame is long enough to carry a checksum and it matches, for telling a frame damaged on the way apart from 
+	//     one that arrived intact but can't be decoded (e.g. the BMS answered with an error)
+	bool ValidateResponseChecksum(const std::vector<uint8_t>& response);
+
 	struct DateTime
 	{
 		uint16_t Year;
@@ -73,19 +101,41 @@ protected:
 	OPTIONAL_NS::optional<std::string> detected_variant;
 
 	// dependency injection
-	LogFuncPtr LogErrorPtr;
-	LogFuncPtr LogWarningPtr;
-	LogFuncPtr LogInfoPtr;
-	LogFuncPtr LogDebugPtr;
-	LogFuncPtr LogVerbosePtr;
-	LogFuncPtr LogVeryVerbosePtr;
-
-	void LogError(std::string message);
-	void LogWarning(std::string message);
-	void LogInfo(std::string message);
-	void LogDebug(std::string message);
-	void LogVerbose(std::string message);
-	void LogVeryVerbose(std::string message);
+	LogFuncPtr LogPtr;
+
+	void Log(LogLevel level, const char* format, va_list args);
+
+	// levels below PACE_BMS_LOG_LEVEL become empty inline functions and disappear at the call site
+#if PACE_BMS_LOG_LEVEL >= 1
+	void LogError(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogError(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 2
+	void LogWarning(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogWarning(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 3
+	void LogInfo(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogInfo(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 5
+	void LogDebug(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogDebug(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 6
+	void LogVerbose(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogVerbose(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
+#if PACE_BMS_LOG_LEVEL >= 7
+	void LogVeryVerbose(const char* format, ...) PACE_BMS_LOG_FORMAT;
+#else
+	void LogVeryVerbose(const char* format, ...) PACE_BMS_LOG_FORMAT {}
+#endif
 
 	// Takes a length value and adds a checksum to the upper nibble, this is "CKLEN" used in command or response headers
 	static uint16_t CreateChecksummedLength(const uint16_t cklen);
@@ -128,10 +178,20 @@ protected:
 	// encode a 'real' int16_t to the stream by writing four ASCII hex encoded bytes
 	void WriteHexEncodedSShort(std::vector<uint8_t>& data, uint16_t& dataOffset, int16_t sshort);
 
-	std::string FormatReturnCode(const uint8_t returnCode);
+	const char* FormatReturnCode(const uint8_t returnCode);
+
+	// integer-only helpers for the "extras" calculated from analog information, so that parsing doesn't need float math 
+	//     (no FPU on 8266 or RP2040) - scaling to floating point units only happens once, when a value is published
+	// returns numerator / denominator in hundredths of a percent, or 0 if denominator is 0
+	static uint16_t CalculateHundredthsPercent(const uint32_t numerator, const uint32_t denominator);
+	// voltage * current with the result in milliwatts
+	static int32_t CalculatePowerMilliwatts(const uint16_t totalVoltageMillivolts, const int32_t currentMilliamps);
+	// min / max / average / max differential across the cell voltage array in a single pass, all zero if cellCount is 0
+	static void CalculateCellVoltageStatistics(const uint16_t* cellVoltagesMillivolts, const uint8_t cellCount, 
+		uint16_t& minCellVoltageMillivolts, uint16_t& maxCellVoltageMillivolts, uint16_t& avgCellVoltageMillivolts, uint16_t& maxCellDifferentialMillivolts);
 
-	void CreateRequest(const uint8_t busId, const uint8_t cid2, const std::vector<uint8_t> payload, std::vector<uint8_t>& request);
+	void CreateRequest(const uint8_t busId, const uint8_t cid2, const std::vector<uint8_t>& payload, std::vector<uint8_t>& request);
 
-	int16_t ValidateResponseAndGetPayloadLength(const uint8_t busId, const std::vector<uint8_t> response);
+	int16_t ValidateResponseAndGetPayloadLength(const uint8_t busId, const std::vector<uint8_t>& response);
 };
 
@@ -1,13 +1,13 @@
 
 #include "pace_bms_protocol_v20.h"
 
-// takes pointers to the "real" logging functions
+// takes a pointer to the "real" logging function
 PaceBmsProtocolV20::PaceBmsProtocolV20(
 	OPTIONAL_NS::optional<std::string> protocol_variant, OPTIONAL_NS::optional<uint8_t> protocol_version_override, OPTIONAL_NS::optional<uint8_t> batteryChemistry,
-	LogFuncPtr logError, LogFuncPtr logWarning, LogFuncPtr logInfo, LogFuncPtr logDebug, LogFuncPtr logVerbose, LogFuncPtr logVeryVerbose) :
+	LogFuncPtr log) :
 	PaceBmsProtocolBase(
 		0x20, protocol_variant, protocol_version_override, batteryChemistry,
-		logError, logWarning, logInfo, logDebug, logVerbose, logVeryVerbose)
+		log)
 {
 }
 
@@ -41,8 +41,8 @@ bool PaceBmsProtocolV20::CreateReadAnalogInformationRequest(const uint8_t busId,
 }
 bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse(const uint8_t busId, const std::vector<uint8_t>& response, AnalogInformation& analogInformation)
 {
-	// save in order compare against what ProcessReadStatusInformationResponse sussed out
-	OPTIONAL_NS::optional<std::string> previously_detected_variant = OPTIONAL_NS::optional<std::string>(detected_variant.value());
+	// save in order compare against what ProcessReadStatusInformationResponse sussed out (copy the optional, it is empty until something has been detected)
+	OPTIONAL_NS::optional<std::string> previously_detected_variant = detected_variant;
 
 	// try to auto-detect the protocol variant
 	//if (!detected_variant.has_value()) 
@@ -51,7 +51,7 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse(const uint8_t busI
 
 		bool isEG4 = false;
 		byteOffset = 13 + 116;
-		if (response.size() - byteOffset > 2)
+		if (response.size() > (size_t)byteOffset + 2)
 		{
 			uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 			if (byte == 15)
@@ -60,16 +60,16 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse(const uint8_t busI
 
 		bool isPylon = false;
 		byteOffset = 13 + 106;
-		if (response.size() - byteOffset > 2)
+		if (response.size() > (size_t)byteOffset + 2)
 		{
 			uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 			if (byte == 02)
-				isEG4 = true;
+				isPylon = true;
 		}
 
 		bool isSeplos = false;
 		byteOffset = 13 + 106;
-		if (response.size() - byteOffset > 2)
+		if (response.size() > (size_t)byteOffset + 2)
 		{
 			uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 			if (byte == 10)
@@ -109,14 +109,14 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse(const uint8_t busI
 	if (protocol_variant.has_value() && detected_variant.has_value() &&
 		protocol_variant.value() != detected_variant.value())
 	{
-		LogWarning("Auto-detected protocol variant '" + detected_variant.value() + "' does not match configured protocol variant '" + protocol_variant.value() + "', using configured value.");
+		LogWarning("Auto-detected protocol variant '%s' does not match configured protocol variant '%s', using configured value.", detected_variant.value().c_str(), protocol_variant.value().c_str());
 	}
 
 	// does detected variant conflict with what ProcessReadAnalogInformationResponse detected?
 	if (previously_detected_variant.has_value() && detected_variant.has_value() &&
 		previously_detected_variant.value() != detected_variant.value())
 	{
-		LogWarning("Auto-detected protocol variant '" + detected_variant.value() + "' does not match previously detected protocol variant '" + protocol_variant.value() + "' determined via a different method, using newly detected value.");
+		LogWarning("Auto-detected protocol variant '%s' does not match previously detected protocol variant '%s' determined via a different method, using newly detected value.", detected_variant.value().c_str(), previously_detected_variant.value().c_str());
 	}
 
 	// decide what variant to use
@@ -147,7 +147,7 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse(const uint8_t busI
 	}
 	else
 	{
-		LogError("Invalid protocol variant '" + variant_to_use + "'");
+		LogError("Invalid protocol variant '%s'", variant_to_use.c_str());
 		return false;
 	}
 }
@@ -185,6 +185,9 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_PYLON(const uint8_
 			continue;
 		analogInformation.cellVoltagesMillivolts[i] = cellVoltage;
 	}
+	// everything past here only looks at what we kept
+	if (analogInformation.cellCount > MAX_CELL_COUNT)
+		analogInformation.cellCount = MAX_CELL_COUNT;
 
 	analogInformation.temperatureCount = ReadHexEncodedByte(response, byteOffset);
 	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
@@ -196,6 +199,8 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_PYLON(const uint8_
 			continue;
 		analogInformation.temperaturesTenthsCelcius[i] = (temperature - 2730);
 	}
+	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
+		analogInformation.temperatureCount = MAX_TEMP_COUNT;
 
 	analogInformation.currentMilliamps = ReadHexEncodedSShort(response, byteOffset) * 10;
 	analogInformation.totalVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset) * 10;
@@ -209,26 +214,15 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_PYLON(const uint8_
 	analogInformation.cycleCount = ReadHexEncodedUShort(response, byteOffset);
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading analog information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading analog information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// calculate some "extras"
-	analogInformation.SoC = ((float)analogInformation.remainingCapacityMilliampHours / (float)analogInformation.fullCapacityMilliampHours);
+	analogInformation.SoCHundredthsPercent = CalculateHundredthsPercent(analogInformation.remainingCapacityMilliampHours, analogInformation.fullCapacityMilliampHours);
 	// SoH not possible without design capacity information
 	// todo: allow user specified design capacity override?
-	analogInformation.powerWatts = ((float)analogInformation.totalVoltageMillivolts * (float)analogInformation.currentMilliamps) / 1000000.0f;
-	analogInformation.minCellVoltageMillivolts = 65535;
-	analogInformation.maxCellVoltageMillivolts = 0;
-	analogInformation.avgCellVoltageMillivolts = 0;
-	for (int i = 0; i < analogInformation.cellCount; i++)
-	{
-		if (analogInformation.cellVoltagesMillivolts[i] > analogInformation.maxCellVoltageMillivolts)
-			analogInformation.maxCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		if (analogInformation.cellVoltagesMillivolts[i] < analogInformation.minCellVoltageMillivolts)
-			analogInformation.minCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		analogInformation.avgCellVoltageMillivolts += analogInformation.cellVoltagesMillivolts[i];
-	}
-	analogInformation.avgCellVoltageMillivolts /= analogInformation.cellCount;
-	analogInformation.maxCellDifferentialMillivolts = analogInformation.maxCellVoltageMillivolts - analogInformation.minCellVoltageMillivolts;
+	analogInformation.powerMilliwatts = CalculatePowerMilliwatts(analogInformation.totalVoltageMillivolts, analogInformation.currentMilliamps);
+	CalculateCellVoltageStatistics(analogInformation.cellVoltagesMillivolts, analogInformation.cellCount,
+		analogInformation.minCellVoltageMillivolts, analogInformation.maxCellVoltageMillivolts, analogInformation.avgCellVoltageMillivolts, analogInformation.maxCellDifferentialMillivolts);
 
 	return true;
 }
@@ -264,6 +258,9 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_SEPLOS(const uint8
 			continue;
 		analogInformation.cellVoltagesMillivolts[i] = cellVoltage;
 	}
+	// everything past here only looks at what we kept
+	if (analogInformation.cellCount > MAX_CELL_COUNT)
+		analogInformation.cellCount = MAX_CELL_COUNT;
 
 	analogInformation.temperatureCount = ReadHexEncodedByte(response, byteOffset);
 	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
@@ -275,6 +272,8 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_SEPLOS(const uint8
 			continue;
 		analogInformation.temperaturesTenthsCelcius[i] = (temperature - 2730);
 	}
+	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
+		analogInformation.temperatureCount = MAX_TEMP_COUNT;
 
 	analogInformation.currentMilliamps = ReadHexEncodedSShort(response, byteOffset) * 10;
 	analogInformation.totalVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset) * 10;
@@ -285,10 +284,10 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_SEPLOS(const uint8
 		LogWarning("Response contains a constant with an unexpected value, this may be an incorrect protocol variant");
 
 	analogInformation.fullCapacityMilliampHours = ReadHexEncodedUShort(response, byteOffset) * 10;
-	analogInformation.SoC = ReadHexEncodedUShort(response, byteOffset);
+	analogInformation.SoCHundredthsPercent = CalculateHundredthsPercent(ReadHexEncodedUShort(response, byteOffset), 100);
 	analogInformation.designCapacityMilliampHours = ReadHexEncodedUShort(response, byteOffset);
 	analogInformation.cycleCount = ReadHexEncodedUShort(response, byteOffset);
-	analogInformation.SoH = ReadHexEncodedUShort(response, byteOffset);
+	analogInformation.SoHHundredthsPercent = CalculateHundredthsPercent(ReadHexEncodedUShort(response, byteOffset), 100);
 
 	//todo: expose? what even is it?
 	uint16_t portVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset) * 10;
@@ -297,23 +296,12 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_SEPLOS(const uint8
 	byteOffset += 16;
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading analog information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading analog information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// calculate some "extras"
-	analogInformation.powerWatts = ((float)analogInformation.totalVoltageMillivolts * (float)analogInformation.currentMilliamps) / 1000000.0f;
-	analogInformation.minCellVoltageMillivolts = 65535;
-	analogInformation.maxCellVoltageMillivolts = 0;
-	analogInformation.avgCellVoltageMillivolts = 0;
-	for (int i = 0; i < analogInformation.cellCount; i++)
-	{
-		if (analogInformation.cellVoltagesMillivolts[i] > analogInformation.maxCellVoltageMillivolts)
-			analogInformation.maxCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		if (analogInformation.cellVoltagesMillivolts[i] < analogInformation.minCellVoltageMillivolts)
-			analogInformation.minCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		analogInformation.avgCellVoltageMillivolts += analogInformation.cellVoltagesMillivolts[i];
-	}
-	analogInformation.avgCellVoltageMillivolts /= analogInformation.cellCount;
-	analogInformation.maxCellDifferentialMillivolts = analogInformation.maxCellVoltageMillivolts - analogInformation.minCellVoltageMillivolts;
+	analogInformation.powerMilliwatts = CalculatePowerMilliwatts(analogInformation.totalVoltageMillivolts, analogInformation.currentMilliamps);
+	CalculateCellVoltageStatistics(analogInformation.cellVoltagesMillivolts, analogInformation.cellCount,
+		analogInformation.minCellVoltageMillivolts, analogInformation.maxCellVoltageMillivolts, analogInformation.avgCellVoltageMillivolts, analogInformation.maxCellDifferentialMillivolts);
 
 	return true;
 }
@@ -349,6 +337,9 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_EG4(const uint8_t
 			continue;
 		analogInformation.cellVoltagesMillivolts[i] = cellVoltage;
 	}
+	// everything past here only looks at what we kept
+	if (analogInformation.cellCount > MAX_CELL_COUNT)
+		analogInformation.cellCount = MAX_CELL_COUNT;
 
 	analogInformation.temperatureCount = ReadHexEncodedByte(response, byteOffset);
 	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
@@ -363,6 +354,8 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_EG4(const uint8_t
 			continue;
 		analogInformation.temperaturesTenthsCelcius[i] = (temperature - 2730);
 	}
+	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
+		analogInformation.temperatureCount = MAX_TEMP_COUNT;
 
 	analogInformation.currentMilliamps = ReadHexEncodedSShort(response, byteOffset) * 10;
 	analogInformation.totalVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset) * 10;
@@ -372,10 +365,10 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_EG4(const uint8_t
 
 	uint8_t UD15 = ReadHexEncodedByte(response, byteOffset);
 	if (UD15 != 15)
-		LogWarning("Response contains a constant with an unexpected value '" + std::to_string(UD15) + "', this may be an incorrect protocol variant");
+		LogWarning("Response contains a constant with an unexpected value '%i', this may be an incorrect protocol variant", UD15);
 
-	analogInformation.SoC = ReadHexEncodedUShort(response, byteOffset);
-	analogInformation.SoH = ReadHexEncodedUShort(response, byteOffset);
+	analogInformation.SoCHundredthsPercent = CalculateHundredthsPercent(ReadHexEncodedUShort(response, byteOffset), 100);
+	analogInformation.SoHHundredthsPercent = CalculateHundredthsPercent(ReadHexEncodedUShort(response, byteOffset), 100);
 
 	analogInformation.maxCellVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset);
 	analogInformation.minCellVoltageMillivolts = ReadHexEncodedUShort(response, byteOffset);
@@ -398,13 +391,14 @@ bool PaceBmsProtocolV20::ProcessReadAnalogInformationResponse_EG4(const uint8_t
 	uint16_t cumulativeDischargeOccurences = ReadHexEncodedUShort(response, byteOffset);
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading analog information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading analog information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// calculate some "extras"
-	analogInformation.powerWatts = ((float)analogInformation.totalVoltageMillivolts * (float)analogInformation.currentMilliamps) / 1000000.0f;
-	for (int i = 0; i < analogInformation.cellCount; i++)
-		analogInformation.avgCellVoltageMillivolts += analogInformation.cellVoltagesMillivolts[i];
-	analogInformation.avgCellVoltageMillivolts /= analogInformation.cellCount;
+	analogInformation.powerMilliwatts = CalculatePowerMilliwatts(analogInformation.totalVoltageMillivolts, analogInformation.currentMilliamps);
+	// min/max/differential are reported directly by this variant, only the average needs calculating
+	uint16_t unusedMinCellVoltageMillivolts, unusedMaxCellVoltageMillivolts, unusedMaxCellDifferentialMillivolts;
+	CalculateCellVoltageStatistics(analogInformation.cellVoltagesMillivolts, analogInformation.cellCount,
+		unusedMinCellVoltageMillivolts, unusedMaxCellVoltageMillivolts, analogInformation.avgCellVoltageMillivolts, unusedMaxCellDifferentialMillivolts);
 
 	return true;
 }
@@ -1285,8 +1279,8 @@ void PaceBmsProtocolV20::StatusDecode_EG4::DecodeSystemStatus(const uint8_t val,
 
 bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busId, const std::vector<uint8_t>& response, StatusInformation& statusInformation)
 {
-	// save in order compare against what ProcessReadAnalogInformationResponse sussed out
-	OPTIONAL_NS::optional<std::string> previously_detected_variant = OPTIONAL_NS::optional<std::string>(detected_variant.value());
+	// save in order compare against what ProcessReadAnalogInformationResponse sussed out (copy the optional, it is empty until something has been detected)
+	OPTIONAL_NS::optional<std::string> previously_detected_variant = detected_variant;
 
 	// try to auto-detect the protocol variant
 	//if (!detected_variant.has_value())
@@ -1295,7 +1289,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busI
 
 		bool isEG4 = false;
 		byteOffset = 13 + 56;
-		if (response.size() - byteOffset > 2)
+		if (response.size() > (size_t)byteOffset + 2)
 		{
 			uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 			if (byte == 9)
@@ -1305,7 +1299,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busI
 		// I considered sniffing this out via payload length, but pylon doesn't contain any UD value and length may overlap between variants, plus I don't have a confirmed example!
 		bool isPylon = false;
 		//byteOffset = 13 + 56;
-		//if (response.size() - byteOffset > 2)
+		//if (response.size() > (size_t)byteOffset + 2)
 		//{
 		//	uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 		//	if (byte == 02)
@@ -1314,7 +1308,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busI
 
 		bool isSeplos = false;
 		byteOffset = 13 + 56;
-		if (response.size() - byteOffset > 2)
+		if (response.size() > (size_t)byteOffset + 2)
 		{
 			uint8_t byte = ReadHexEncodedByte(response, byteOffset);
 			if (byte == 20)
@@ -1354,14 +1348,14 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busI
 	if (protocol_variant.has_value() && detected_variant.has_value() &&
 		protocol_variant.value() != detected_variant.value())
 	{
-		LogWarning("Auto-detected protocol variant '" + detected_variant.value() + "' does not match configured protocol variant '" + protocol_variant.value() + "', using configured value.");
+		LogWarning("Auto-detected protocol variant '%s' does not match configured protocol variant '%s', using configured value.", detected_variant.value().c_str(), protocol_variant.value().c_str());
 	}
 
 	// does detected variant conflict with what ProcessReadAnalogInformationResponse detected?
 	if (previously_detected_variant.has_value() && detected_variant.has_value() &&
 		previously_detected_variant.value() != detected_variant.value())
 	{
-		LogWarning("Auto-detected protocol variant '" + detected_variant.value() + "' does not match previously detected protocol variant '" + protocol_variant.value() + "' determined via a different method, using newly detected value.");
+		LogWarning("Auto-detected protocol variant '%s' does not match previously detected protocol variant '%s' determined via a different method, using newly detected value.", detected_variant.value().c_str(), previously_detected_variant.value().c_str());
 	}
 
 	// decide what variant to use
@@ -1392,7 +1386,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse(const uint8_t busI
 	}
 	else
 	{
-		LogError("Invalid protocol variant '" + variant_to_use + "'");
+		LogError("Invalid protocol variant '%s'", variant_to_use.c_str());
 		return false;
 	}
 }
@@ -1423,9 +1417,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_PYLON(const uint8_
 	for (int i = 0; i < cellCount; i++)
 	{
 		uint8_t cw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_cell[i] = cw;
 		if (i > MAX_CELL_COUNT - 1)
 			continue;
+		statusInformation.warning_value_cell[i] = cw;
 		if (cw == 0)
 			continue;
 		// below/above limit
@@ -1438,9 +1432,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_PYLON(const uint8_
 	for (int i = 0; i < tempCount; i++)
 	{
 		uint8_t tw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_temp[i] = tw;
 		if (i > MAX_TEMP_COUNT - 1)
 			continue;
+		statusInformation.warning_value_temp[i] = tw;
 		if (tw == 0)
 			continue;
 		// below/above limit
@@ -1487,7 +1481,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_PYLON(const uint8_
 		StatusDecode_PYLON::DecodeStatus5Value(statusInformation.status5_value, statusInformation.faultText);
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading status information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading status information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// pop off any trailing "; " separator
 	if (statusInformation.warningText.length() > 2)
@@ -1550,9 +1544,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_SEPLOS(const uint8
 	for (int i = 0; i < cellCount; i++)
 	{
 		uint8_t cw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_cell[i] = cw;
 		if (i > MAX_CELL_COUNT - 1)
 			continue;
+		statusInformation.warning_value_cell[i] = cw;
 		if (cw == 0)
 			continue;
 		// below/above limit
@@ -1565,9 +1559,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_SEPLOS(const uint8
 	for (int i = 0; i < tempCount; i++)
 	{
 		uint8_t tw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_temp[i] = tw;
 		if (i > MAX_TEMP_COUNT - 1)
 			continue;
+		statusInformation.warning_value_temp[i] = tw;
 		if (tw == 0)
 			continue;
 		// below/above limit
@@ -1662,7 +1656,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_SEPLOS(const uint8
 	byteOffset += 12; // 6 one byte values as two byte hexascii
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading status information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading status information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// pop off any trailing "; " separator
 	if (statusInformation.warningText.length() > 2)
@@ -1725,9 +1719,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_EG4(const uint8_t
 	for (int i = 0; i < cellCount; i++)
 	{
 		uint8_t cw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_cell[i] = cw;
 		if (i > MAX_CELL_COUNT - 1)
 			continue;
+		statusInformation.warning_value_cell[i] = cw;
 		if (cw == 0)
 			continue;
 		// below/above limit
@@ -1743,9 +1737,9 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_EG4(const uint8_t
 	for (int i = 0; i < tempCount; i++)
 	{
 		uint8_t tw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_temp[i] = tw;
 		if (i > MAX_TEMP_COUNT - 1)
 			continue;
+		statusInformation.warning_value_temp[i] = tw;
 		if (tw == 0)
 			continue;
 		// below/above limit
@@ -1819,7 +1813,7 @@ bool PaceBmsProtocolV20::ProcessReadStatusInformationResponse_EG4(const uint8_t
 	byteOffset += 2;
 
 	if (byteOffset != payloadLen + 13)
-		LogWarning("Length mismatch reading status information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off");
+		LogWarning("Length mismatch reading status information response: %i bytes off", payloadLen + 13 - byteOffset);
 
 	// pop off any trailing "; " separator
 	if (statusInformation.warningText.length() > 2)
@@ -1880,8 +1874,7 @@ bool PaceBmsProtocolV20::ProcessReadHardwareVersionResponse(const uint8_t busId,
 
 	if (payloadLen != 64)
 	{
-		//std::string message = std::string("Documentation indicates a hardware version request should return a 64 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		//LogWarning(message);
+		//LogWarning("Documentation indicates a hardware version request should return a 64 byte payload in the response, but this response's payload length is %i", payloadLen);
 	}
 
 	// attempt to format the garbage that off-brand BMSes return into something legible
@@ -1910,7 +1903,7 @@ bool PaceBmsProtocolV20::ProcessReadHardwareVersionResponse(const uint8_t busId,
 		else
 			hardwareVersion.append("[" + std::to_string(byte) + "]");
 	}
-	if (hardwareVersion[hardwareVersion.length() - 1] == ' ')
+	if (hardwareVersion.length() > 0 && hardwareVersion[hardwareVersion.length() - 1] == ' ')
 		hardwareVersion.pop_back();
 
 	return true;
@@ -1938,8 +1931,7 @@ bool PaceBmsProtocolV20::ProcessReadSerialNumberResponse(const uint8_t busId, co
 
 	if (payloadLen != 80 && payloadLen != 32)
 	{
-		std::string message = std::string("Documentation indicates a serial number information request should return either a 32 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		LogWarning(message);
+		LogWarning("Documentation indicates a serial number information request should return either a 32 byte payload in the response, but this response's payload length is %i", payloadLen);
 	}
 
 	//// throwaway -- I'm torn whether to do this or not, the spec says there's a byte we don't care about 
@@ -1972,7 +1964,7 @@ bool PaceBmsProtocolV20::ProcessReadSerialNumberResponse(const uint8_t busId, co
 		else
 			serialNumber.append("[" + std::to_string(byte) + "]");
 	}
-	if (serialNumber[serialNumber.length() - 1] == ' ')
+	if (serialNumber.length() > 0 && serialNumber[serialNumber.length() - 1] == ' ')
 		serialNumber.pop_back();
 
 	return true;
@@ -2008,8 +2000,7 @@ bool PaceBmsProtocolV20::ProcessWriteShutdownCommandResponse(const uint8_t busId
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a shutdown command should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a shutdown command should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -2076,8 +2067,7 @@ bool PaceBmsProtocolV20::ProcessWriteSystemDateTimeResponse(const uint8_t busId,
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a write system time response should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a write system time response should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
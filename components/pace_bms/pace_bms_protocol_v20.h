@@ -32,13 +32,10 @@ public:
 		CID1_LithiumTitanate_Ternary_EG4 = 0x4F, // undocumented value used by EG4 for lithium titanate with ternary (nickel, cobalt, and manganese or aluminum) cathode
 	};
 
-	// dependency injection
-	typedef void (*LogFuncPtr)(std::string message);
-
-	// takes pointers to the "real" logging functions
+	// takes a pointer to the "real" logging function
 	PaceBmsProtocolV20(
 		OPTIONAL_NS::optional<std::string> protocol_variant, OPTIONAL_NS::optional<uint8_t> protocol_version_override, OPTIONAL_NS::optional<uint8_t> batteryChemistry,
-		LogFuncPtr logError, LogFuncPtr logWarning, LogFuncPtr logInfo, LogFuncPtr logDebug, LogFuncPtr logVerbose, LogFuncPtr logVeryVerbose);
+		LogFuncPtr log);
 
 protected:
 	enum CID2 : uint8_t
@@ -97,9 +94,9 @@ public:
 		uint16_t cycleCount{ 0 };
 		uint32_t designCapacityMilliampHours{ 0 };
 
-		float    SoH{ 0 }; // in percent
-		float    SoC{ 0 }; // in percent
-		float    powerWatts{ 0 };
+		uint16_t SoHHundredthsPercent{ 0 };
+		uint16_t SoCHundredthsPercent{ 0 };
+		int32_t  powerMilliwatts{ 0 };
 		uint16_t minCellVoltageMillivolts{ 0 };
 		uint16_t maxCellVoltageMillivolts{ 0 };
 		uint16_t avgCellVoltageMillivolts{ 0 };
@@ -1,13 +1,16 @@
 
+#include <cstddef>
+#include <type_traits>
+
 #include "pace_bms_protocol_v25.h"
 
-// takes pointers to the "real" logging functions
+// takes a pointer to the "real" logging function
 PaceBmsProtocolV25::PaceBmsProtocolV25(
 		OPTIONAL_NS::optional<std::string> protocol_variant, OPTIONAL_NS::optional<uint8_t> protocol_version_override, OPTIONAL_NS::optional<uint8_t> batteryChemistry,
-		LogFuncPtr logError, LogFuncPtr logWarning, LogFuncPtr logInfo, LogFuncPtr logDebug, LogFuncPtr logVerbose, LogFuncPtr logVeryVerbose) :
+		LogFuncPtr log) :
 	PaceBmsProtocolBase(
 		0x25, protocol_variant, protocol_version_override, batteryChemistry,
-		logError, logWarning, logInfo, logDebug, logVerbose, logVeryVerbose)
+		log)
 {
 }
 
@@ -75,6 +78,9 @@ bool PaceBmsProtocolV25::ProcessReadAnalogInformationResponse(const uint8_t busI
 
 		analogInformation.cellVoltagesMillivolts[i] = cellVoltage;
 	}
+	// everything past here only looks at what we kept
+	if (analogInformation.cellCount > MAX_CELL_COUNT)
+		analogInformation.cellCount = MAX_CELL_COUNT;
 
 	analogInformation.temperatureCount = ReadHexEncodedByte(response, byteOffset);
 	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
@@ -90,6 +96,8 @@ bool PaceBmsProtocolV25::ProcessReadAnalogInformationResponse(const uint8_t busI
 
 		analogInformation.temperaturesTenthsCelcius[i] = (temperature - 2730);
 	}
+	if (analogInformation.temperatureCount > MAX_TEMP_COUNT)
+		analogInformation.temperatureCount = MAX_TEMP_COUNT;
 
 	analogInformation.currentMilliamps = ReadHexEncodedSShort(response, byteOffset) * 10;
 
@@ -120,32 +128,21 @@ bool PaceBmsProtocolV25::ProcessReadAnalogInformationResponse(const uint8_t busI
 
 	if (byteOffset != payloadLen + 13)
 	{
-		LogError("Length mismatch reading analog information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off. This will be ignored, but please file an issue report with full logs at VERY_VERBOSE level.");
+		LogError("Length mismatch reading analog information response: %i bytes off. This will be ignored, but please file an issue report with full logs at VERY_VERBOSE level.", payloadLen + 13 - byteOffset);
 		//return false;
 	}
 
 	// calculate some "extras"
-	analogInformation.SoC = ((float)analogInformation.remainingCapacityMilliampHours / (float)analogInformation.fullCapacityMilliampHours) * 100.0f;
-	analogInformation.SoH = ((float)analogInformation.fullCapacityMilliampHours / (float)analogInformation.designCapacityMilliampHours) * 100.0f;
-	if (analogInformation.SoH > 100)
+	analogInformation.SoCHundredthsPercent = CalculateHundredthsPercent(analogInformation.remainingCapacityMilliampHours, analogInformation.fullCapacityMilliampHours);
+	analogInformation.SoHHundredthsPercent = CalculateHundredthsPercent(analogInformation.fullCapacityMilliampHours, analogInformation.designCapacityMilliampHours);
+	if (analogInformation.SoHHundredthsPercent > 10000)
 	{
 		// many packs have a little bit "extra" capacity to make sure they hit their nameplate value
-		analogInformation.SoH = 100;
-	}
-	analogInformation.powerWatts = ((float)analogInformation.totalVoltageMillivolts * (float)analogInformation.currentMilliamps) / 1000000.0f;
-	analogInformation.minCellVoltageMillivolts = 65535;
-	analogInformation.maxCellVoltageMillivolts = 0;
-	analogInformation.avgCellVoltageMillivolts = 0;
-	for (int i = 0; i < analogInformation.cellCount; i++)
-	{
-		if (analogInformation.cellVoltagesMillivolts[i] > analogInformation.maxCellVoltageMillivolts)
-			analogInformation.maxCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		if (analogInformation.cellVoltagesMillivolts[i] < analogInformation.minCellVoltageMillivolts)
-			analogInformation.minCellVoltageMillivolts = analogInformation.cellVoltagesMillivolts[i];
-		analogInformation.avgCellVoltageMillivolts += analogInformation.cellVoltagesMillivolts[i];
+		analogInformation.SoHHundredthsPercent = 10000;
 	}
-	analogInformation.avgCellVoltageMillivolts /= analogInformation.cellCount;
-	analogInformation.maxCellDifferentialMillivolts = analogInformation.maxCellVoltageMillivolts - analogInformation.minCellVoltageMillivolts;
+	analogInformation.powerMilliwatts = CalculatePowerMilliwatts(analogInformation.totalVoltageMillivolts, analogInformation.currentMilliamps);
+	CalculateCellVoltageStatistics(analogInformation.cellVoltagesMillivolts, analogInformation.cellCount,
+		analogInformation.minCellVoltageMillivolts, analogInformation.maxCellVoltageMillivolts, analogInformation.avgCellVoltageMillivolts, analogInformation.maxCellDifferentialMillivolts);
 
 	return true;
 }
@@ -519,10 +516,10 @@ bool PaceBmsProtocolV25::ProcessReadStatusInformationResponse(const uint8_t busI
 	for (int i = 0; i < cellCount; i++)
 	{
 		uint8_t cw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_cell[i] = cw;
 
 		if (i > MAX_CELL_COUNT - 1)
 			continue;
+		statusInformation.warning_value_cell[i] = cw;
 
 		if (cw == 0)
 			continue;
@@ -539,10 +536,10 @@ bool PaceBmsProtocolV25::ProcessReadStatusInformationResponse(const uint8_t busI
 	for (int i = 0; i < tempCount; i++)
 	{
 		uint8_t tw = ReadHexEncodedByte(response, byteOffset);
-		statusInformation.warning_value_temp[i] = tw;
 
 		if (i > MAX_TEMP_COUNT - 1)
 			continue;
+		statusInformation.warning_value_temp[i] = tw;
 
 		if (tw == 0)
 			continue;
@@ -651,7 +648,7 @@ bool PaceBmsProtocolV25::ProcessReadStatusInformationResponse(const uint8_t busI
 
 	if (byteOffset != payloadLen + 13)
 	{
-		LogError("Length mismatch reading status information response: " + std::to_string(payloadLen + 13 - byteOffset) + " bytes off. This will be ignored, but please file an issue report with full logs at VERY_VERBOSE level.");
+		LogError("Length mismatch reading status information response: %i bytes off. This will be ignored, but please file an issue report with full logs at VERY_VERBOSE level.", payloadLen + 13 - byteOffset);
 		return false;
 	}
 
@@ -714,8 +711,7 @@ bool PaceBmsProtocolV25::ProcessReadHardwareVersionResponse(const uint8_t busId,
 
 	if (payloadLen != 40)
 	{
-		std::string message = std::string("Documentation indicates a hardware version request should return a 40 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a hardware version request should return a 40 byte payload in the response, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -756,8 +752,7 @@ bool PaceBmsProtocolV25::ProcessReadSerialNumberResponse(const uint8_t busId, co
 
 	if (payloadLen != 80 && payloadLen != 40)
 	{
-		std::string message = std::string("Documentation indicates a serial number information request should return either a 40 or 80 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a serial number information request should return either a 40 or 80 byte payload in the response, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -831,8 +826,7 @@ bool PaceBmsProtocolV25::ProcessWriteSwitchCommandResponse(const uint8_t busId,
 	// in any case this is the only thing I can be certain enough about to elevate to error status and return failure
 	if (payloadLen != 4)
 	{
-		std::string message = std::string("Documentation indicates a switch command should return a 4 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a switch command should return a 4 byte payload in the response, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -940,8 +934,7 @@ bool PaceBmsProtocolV25::ProcessWriteMosfetSwitchCommandResponse(const uint8_t b
 	// in any case this is the only thing I can be certain enough about to elevate to error status and return failure
 	if (payloadLen != 2)
 	{
-		std::string message = std::string("Documentation indicates a MOSFET command should return a 2 byte payload in the response, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a MOSFET command should return a 2 byte payload in the response, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -1008,8 +1001,7 @@ bool PaceBmsProtocolV25::ProcessWriteShutdownCommandResponse(const uint8_t busId
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a shutdown command should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a shutdown command should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -1082,8 +1074,7 @@ bool PaceBmsProtocolV25::ProcessWriteSystemDateTimeResponse(const uint8_t busId,
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a write system time response should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a write system time response should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -1113,20 +1104,54 @@ bool PaceBmsProtocolV25::ProcessWriteConfigurationResponse(const uint8_t busId,
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a write configuration response should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a write configuration response should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
 	return true;
 }
 
-const unsigned char PaceBmsProtocolV25::exampleReadCellOverVoltageConfigurationRequestV25[] = "~250046D10000FD9A\r";
-const unsigned char PaceBmsProtocolV25::exampleReadCellOverVoltageConfigurationResponseV25[] = "~25004600F010010E100E740D340AFA35\r";
-const unsigned char PaceBmsProtocolV25::exampleWriteCellOverVoltageConfigurationRequestV25[] = "~250046D0F010010E100E740D340AFA21\r";
-const unsigned char PaceBmsProtocolV25::exampleWriteCellOverVoltageConfigurationResponseV25[] = "~250046000000FDAF\r";
+typedef PaceBmsProtocolV25::ConfigurationField ConfigurationField;
 
-bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, CellOverVoltageConfiguration& config)
+template<typename T>
+static constexpr ConfigurationField::Storage ConfigurationStorage()
+{
+	static_assert(std::is_same<T, uint8_t>::value || std::is_same<T, int8_t>::value || std::is_same<T, uint16_t>::value, "unsupported configuration member type");
+	return std::is_same<T, uint8_t>::value ? ConfigurationField::STORAGE_UINT8 : std::is_same<T, int8_t>::value ? ConfigurationField::STORAGE_INT8 : ConfigurationField::STORAGE_UINT16;
+}
+
+// the name, location and type of a configuration struct member, the first few arguments of the helpers below
+#define CONFIGURATION_MEMBER(config, member) \
+	#member, offsetof(PaceBmsProtocolV25::config, member), ConfigurationStorage<decltype(PaceBmsProtocolV25::config::member)>()
+
+// a value stored directly, or in steps of unit
+static constexpr ConfigurationField ConfigurationValue(const char* name, const uint8_t offset, const ConfigurationField::Storage storage, const ConfigurationField::Wire wire, 
+	const int32_t min, const int32_t max, const uint16_t step = 0, const uint8_t unit = 1)
+{
+	return ConfigurationField{ name, offset, storage, wire, 1, unit, 0, min, max, step };
+}
+
+// a temperature in whole degrees, stored as (value * 10) + 2730
+static constexpr ConfigurationField ConfigurationTemperature(const char* name, const uint8_t offset, const ConfigurationField::Storage storage, const int32_t min, const int32_t max)
+{
+	return ConfigurationField{ name, offset, storage, ConfigurationField::WIRE_USHORT, 10, 1, 2730, min, max, 0 };
+}
+
+// a byte that has only ever been seen with one value, meaning unknown
+static constexpr ConfigurationField ConfigurationConstant(const uint8_t value)
+{
+	return ConfigurationField{ "Unknown", 0, ConfigurationField::STORAGE_CONSTANT, ConfigurationField::WIRE_BYTE, 1, 1, 0, value, value, 0 };
+}
+
+static uint16_t ConfigurationPayloadLength(const ConfigurationField* fields, const uint8_t fieldCount)
+{
+	uint16_t payloadLen = 0;
+	for (uint8_t i = 0; i < fieldCount; i++)
+		payloadLen += fields[i].wire == ConfigurationField::WIRE_BYTE ? 2 : 4;
+	return payloadLen;
+}
+
+bool PaceBmsProtocolV25::DecodeConfiguration(const uint8_t busId, const std::vector<uint8_t>& response, const ConfigurationField* fields, const uint8_t fieldCount, void* config)
 {
 	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
 	if (payloadLen == -1)
@@ -1134,172 +1159,158 @@ bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, c
 		// failed to validate, the call would have done it's own logging
 		return false;
 	}
-	// todo: everywhere check payload length is what's expected
+
+	// some firmware sends a garbage tail (see Discharge Over Current 2), so only a short payload is a problem
+	const uint16_t expectedPayloadLen = ConfigurationPayloadLength(fields, fieldCount);
+	if (payloadLen < expectedPayloadLen)
+	{
+		LogError("Configuration response payload length is %i but should be at least %i", payloadLen, expectedPayloadLen);
+		return false;
+	}
 
 	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
 	uint16_t byteOffset = 13;
 
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
+	for (uint8_t i = 0; i < fieldCount; i++)
 	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
+		const ConfigurationField& field = fields[i];
+
+		int32_t wire = 0;
+		switch (field.wire)
+		{
+		case ConfigurationField::WIRE_BYTE:
+			wire = ReadHexEncodedByte(response, byteOffset);
+			break;
+		case ConfigurationField::WIRE_USHORT:
+			wire = ReadHexEncodedUShort(response, byteOffset);
+			break;
+		case ConfigurationField::WIRE_NEGATED_SSHORT:
+			wire = ReadHexEncodedSShort(response, byteOffset) * -1;
+			break;
+		}
 
-	config.AlarmMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionReleaseMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
+		if (field.storage == ConfigurationField::STORAGE_CONSTANT)
+		{
+			if (wire != field.min)
+			{
+				LogWarning("Unknown payload byte does not match previously observed value");
+				return false;
+			}
+			continue;
+		}
+
+		int32_t value = (wire - field.bias) * field.unit / field.scale;
+		uint8_t* member = (uint8_t*)config + field.offset;
+		switch (field.storage)
+		{
+		case ConfigurationField::STORAGE_UINT8:
+			*member = (uint8_t)value;
+			break;
+		case ConfigurationField::STORAGE_INT8:
+			*(int8_t*)member = (int8_t)value;
+			break;
+		case ConfigurationField::STORAGE_UINT16:
+			*(uint16_t*)member = (uint16_t)value;
+			break;
+		default:
+			break;
+		}
+	}
 
 	return true;
 }
-bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const CellOverVoltageConfiguration& config, std::vector<uint8_t>& request)
+bool PaceBmsProtocolV25::EncodeConfiguration(const uint8_t busId, const CID2 cid2, const ConfigurationField* fields, const uint8_t fieldCount, const void* config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmMillivolts < 2500 || config.AlarmMillivolts > 4500)
-	{
-		LogError("AlarmVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.AlarmMillivolts % 10 != 0)
-	{
-		LogError("AlarmVoltage should be in steps of 0.01 volts");
-		return false;
-	}
-	if (config.ProtectionMillivolts < 2500 || config.ProtectionMillivolts > 4500)
-	{
-		LogError("ProtectionVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionMillivolts % 10 != 0)
-	{
-		LogError("ProtectionVoltage should be in steps of 0.01 volts");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts < 2500 || config.ProtectionReleaseMillivolts > 4500)
-	{
-		LogError("ProtectionReleaseVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts % 10 != 0)
-	{
-		LogError("ProtectionReleaseVoltage should be in steps of 0.01 volts");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 1000 || config.ProtectionDelayMilliseconds > 20000)
-	{
-		LogError("ProtectionDelaySeconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
+	std::vector<uint8_t> payload(ConfigurationPayloadLength(fields, fieldCount));
+	uint16_t payloadOffset = 0;
+
+	for (uint8_t i = 0; i < fieldCount; i++)
 	{
-		LogError("ProtectionDelaySeconds should be in steps of 0.5 seconds");
-		return false;
-	}
+		const ConfigurationField& field = fields[i];
 
-	const uint16_t payloadLen = 16;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionReleaseMillivolts);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
+		const uint8_t* member = (const uint8_t*)config + field.offset;
+		int32_t value = field.min;
+		switch (field.storage)
+		{
+		case ConfigurationField::STORAGE_UINT8:
+			value = *member;
+			break;
+		case ConfigurationField::STORAGE_INT8:
+			value = *(const int8_t*)member;
+			break;
+		case ConfigurationField::STORAGE_UINT16:
+			value = *(const uint16_t*)member;
+			break;
+		default:
+			break;
+		}
+
+		// validate values conform to what PBmsTools would send
+		if (value < field.min || value > field.max)
+		{
+			LogError("%s is not in the range that PBmsTools would send (or expect back)", field.name);
+			return false;
+		}
+		if (field.step != 0 && value % field.step != 0)
+		{
+			LogError("%s should be in steps of %i", field.name, field.step);
+			return false;
+		}
 
-	CreateRequest(busId, CID2_WriteCellOverVoltageConfiguration, payload, request);
+		int32_t wire = (value * field.scale / field.unit) + field.bias;
+		if (field.wire == ConfigurationField::WIRE_BYTE)
+			WriteHexEncodedByte(payload, payloadOffset, (uint8_t)wire);
+		else
+			WriteHexEncodedUShort(payload, payloadOffset, (uint16_t)wire);
+	}
+
+	CreateRequest(busId, cid2, payload, request);
 
 	return true;
 }
 
+const unsigned char PaceBmsProtocolV25::exampleReadCellOverVoltageConfigurationRequestV25[] = "~250046D10000FD9A\r";
+const unsigned char PaceBmsProtocolV25::exampleReadCellOverVoltageConfigurationResponseV25[] = "~25004600F010010E100E740D340AFA35\r";
+const unsigned char PaceBmsProtocolV25::exampleWriteCellOverVoltageConfigurationRequestV25[] = "~250046D0F010010E100E740D340AFA21\r";
+const unsigned char PaceBmsProtocolV25::exampleWriteCellOverVoltageConfigurationResponseV25[] = "~250046000000FDAF\r";
+
+static constexpr ConfigurationField cellOverVoltageConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellOverVoltageConfiguration, AlarmMillivolts), ConfigurationField::WIRE_USHORT, 2500, 4500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellOverVoltageConfiguration, ProtectionMillivolts), ConfigurationField::WIRE_USHORT, 2500, 4500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellOverVoltageConfiguration, ProtectionReleaseMillivolts), ConfigurationField::WIRE_USHORT, 2500, 4500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellOverVoltageConfiguration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 1000, 20000, 500, 100),
+};
+
+bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, CellOverVoltageConfiguration& config)
+{
+	return DecodeConfiguration(busId, response, cellOverVoltageConfigurationFields, config);
+}
+bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const CellOverVoltageConfiguration& config, std::vector<uint8_t>& request)
+{
+	return EncodeConfiguration(busId, CID2_WriteCellOverVoltageConfiguration, cellOverVoltageConfigurationFields, config, request);
+}
+
 const unsigned char PaceBmsProtocolV25::exampleReadPackOverVoltageConfigurationRequestV25[] = "~250046D50000FD96\r";
 const unsigned char PaceBmsProtocolV25::exampleReadPackOverVoltageConfigurationResponseV25[] = "~25004600F01001E100E740D2F00AFA24\r";
 const unsigned char PaceBmsProtocolV25::exampleWritePackOverVoltageConfigurationRequestV25[] = "~250046D4F01001E10AE740D2F00AF9FB\r";
 const unsigned char PaceBmsProtocolV25::exampleWritePackOverVoltageConfigurationResponseV25[] = "~250046000000FDAF\r";
 
-bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t> response, PackOverVoltageConfiguration& config)
-{
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.AlarmMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionReleaseMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
+static constexpr ConfigurationField packOverVoltageConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackOverVoltageConfiguration, AlarmMillivolts), ConfigurationField::WIRE_USHORT, 20000, 65000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackOverVoltageConfiguration, ProtectionMillivolts), ConfigurationField::WIRE_USHORT, 20000, 65000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackOverVoltageConfiguration, ProtectionReleaseMillivolts), ConfigurationField::WIRE_USHORT, 20000, 65000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackOverVoltageConfiguration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 1000, 20000, 500, 100),
+};
 
-	return true;
+bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, PackOverVoltageConfiguration& config)
+{
+	return DecodeConfiguration(busId, response, packOverVoltageConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const PackOverVoltageConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmMillivolts < 20000 || config.AlarmMillivolts > 65000)
-	{
-		LogError("AlarmVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.AlarmMillivolts % 10)
-	{
-		LogError("AlarmVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionMillivolts < 20000 || config.ProtectionMillivolts > 65000)
-	{
-		LogError("ProtectionVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionMillivolts % 10 != 0)
-	{
-		LogError("ProtectionVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts < 20000 || config.ProtectionReleaseMillivolts > 65000)
-	{
-		LogError("ProtectionReleaseVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts % 10 != 0)
-	{
-		LogError("ProtectionReleaseVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 1000 || config.ProtectionDelayMilliseconds > 20000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 500");
-		return false;
-	}
-
-	const uint16_t payloadLen = 16;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionReleaseMillivolts);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
-
-	CreateRequest(busId, CID2_WritePackOverVoltageConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WritePackOverVoltageConfiguration, packOverVoltageConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadCellUnderVoltageConfigurationRequestV25[] = "~250046D30000FD98\r";
@@ -1307,89 +1318,21 @@ const unsigned char PaceBmsProtocolV25::exampleReadCellUnderVoltageConfiguration
 const unsigned char PaceBmsProtocolV25::exampleWriteCellUnderVoltageConfigurationRequestV25[] = "~250046D2F010010AF009C40B540AFA0E\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteCellUnderVoltageConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField cellUnderVoltageConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellUnderVoltageConfiguration, AlarmMillivolts), ConfigurationField::WIRE_USHORT, 2000, 3500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellUnderVoltageConfiguration, ProtectionMillivolts), ConfigurationField::WIRE_USHORT, 2000, 3500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellUnderVoltageConfiguration, ProtectionReleaseMillivolts), ConfigurationField::WIRE_USHORT, 2000, 3500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellUnderVoltageConfiguration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 1000, 20000, 500, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, CellUnderVoltageConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.AlarmMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionReleaseMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
-
-	return true;
+	return DecodeConfiguration(busId, response, cellUnderVoltageConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const CellUnderVoltageConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmMillivolts < 2000 || config.AlarmMillivolts > 3500)
-	{
-		LogError("AlarmVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.AlarmMillivolts % 10 != 0)
-	{
-		LogError("AlarmVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionMillivolts < 2000 || config.ProtectionMillivolts > 3500)
-	{
-		LogError("ProtectionVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionMillivolts % 10 != 0)
-	{
-		LogError("ProtectionVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts < 2000 || config.ProtectionReleaseMillivolts > 3500)
-	{
-		LogError("ProtectionReleaseVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts % 10 != 0)
-	{
-		LogError("ProtectionReleaseVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 1000 || config.ProtectionDelayMilliseconds > 20000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 500");
-		return false;
-	}
-
-	const uint16_t payloadLen = 16;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionReleaseMillivolts);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
-
-	CreateRequest(busId, CID2_WriteCellUnderVoltageConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteCellUnderVoltageConfiguration, cellUnderVoltageConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadPackUnderVoltageConfigurationRequestV25[] = "~250046D70000FD94\r";
@@ -1397,89 +1340,21 @@ const unsigned char PaceBmsProtocolV25::exampleReadPackUnderVoltageConfiguration
 const unsigned char PaceBmsProtocolV25::exampleWritePackUnderVoltageConfigurationRequestV25[] = "~250046D6F01001AF009C40B5400AFA0A\r";
 const unsigned char PaceBmsProtocolV25::exampleWritePackUnderVoltageConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField packUnderVoltageConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackUnderVoltageConfiguration, AlarmMillivolts), ConfigurationField::WIRE_USHORT, 15000, 50000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackUnderVoltageConfiguration, ProtectionMillivolts), ConfigurationField::WIRE_USHORT, 15000, 50000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackUnderVoltageConfiguration, ProtectionReleaseMillivolts), ConfigurationField::WIRE_USHORT, 15000, 50000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(PackUnderVoltageConfiguration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 1000, 20000, 500, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, PackUnderVoltageConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.AlarmMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionReleaseMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
-
-	return true;
+	return DecodeConfiguration(busId, response, packUnderVoltageConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const PackUnderVoltageConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmMillivolts < 15000 || config.AlarmMillivolts > 50000)
-	{
-		LogError("AlarmVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.AlarmMillivolts % 10 != 0)
-	{
-		LogError("AlarmVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionMillivolts < 15000 || config.ProtectionMillivolts > 50000)
-	{
-		LogError("ProtectionVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionMillivolts % 10 != 0)
-	{
-		LogError("ProtectionVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts < 15000 || config.ProtectionReleaseMillivolts > 50000)
-	{
-		LogError("ProtectionReleaseVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionReleaseMillivolts % 10 != 0)
-	{
-		LogError("ProtectionReleaseVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 1000 || config.ProtectionDelayMilliseconds > 20000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 500");
-		return false;
-	}
-
-	const uint16_t payloadLen = 16;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionReleaseMillivolts);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
-
-	CreateRequest(busId, CID2_WritePackUnderVoltageConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WritePackUnderVoltageConfiguration, packUnderVoltageConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadChargeOverCurrentConfigurationRequestV25[] = "~250046D90000FD92\r";
@@ -1487,69 +1362,20 @@ const unsigned char PaceBmsProtocolV25::exampleReadChargeOverCurrentConfiguratio
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeOverCurrentConfigurationRequestV25[] = "~250046D8400C010068006E0AFB01\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeOverCurrentConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField chargeOverCurrentConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(ChargeOverCurrentConfiguration, AlarmAmperage), ConfigurationField::WIRE_USHORT, 1, 220),
+	ConfigurationValue(CONFIGURATION_MEMBER(ChargeOverCurrentConfiguration, ProtectionAmperage), ConfigurationField::WIRE_USHORT, 1, 220),
+	ConfigurationValue(CONFIGURATION_MEMBER(ChargeOverCurrentConfiguration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 500, 25000, 500, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, ChargeOverCurrentConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.AlarmAmperage = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionAmperage = ReadHexEncodedUShort(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
-
-	return true;
+	return DecodeConfiguration(busId, response, chargeOverCurrentConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const ChargeOverCurrentConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmAmperage < 1 || config.AlarmAmperage > 220)
-	{
-		LogError("AlarmAmperage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionAmperage < 1 || config.ProtectionAmperage > 220)
-	{
-		LogError("ProtectionAmperage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 500 || config.ProtectionDelayMilliseconds > 25000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 500");
-		return false;
-	}
-
-	const uint16_t payloadLen = 12;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmAmperage);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionAmperage);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
-
-	CreateRequest(busId, CID2_WriteChargeOverCurrentConfiguration, payload, request);
-
-	// todo: (everywhere) check alignment of current byteOffset and payloadLen
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteChargeOverCurrentConfiguration, chargeOverCurrentConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadDishargeOverCurrent1ConfigurationRequestV25[] = "~250046DB0000FD89\r";
@@ -1557,67 +1383,20 @@ const unsigned char PaceBmsProtocolV25::exampleReadDishargeOverCurrent1Configura
 const unsigned char PaceBmsProtocolV25::exampleWriteDishargeOverCurrent1ConfigurationRequestV25[] = "~250046DA400C010069006E0AFAF7\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteDishargeOverCurrent1ConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField dischargeOverCurrent1ConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationValue(CONFIGURATION_MEMBER(DischargeOverCurrent1Configuration, AlarmAmperage), ConfigurationField::WIRE_NEGATED_SSHORT, 1, 220),
+	ConfigurationValue(CONFIGURATION_MEMBER(DischargeOverCurrent1Configuration, ProtectionAmperage), ConfigurationField::WIRE_NEGATED_SSHORT, 1, 220),
+	ConfigurationValue(CONFIGURATION_MEMBER(DischargeOverCurrent1Configuration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 500, 25000, 500, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, DischargeOverCurrent1Configuration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.AlarmAmperage = ReadHexEncodedSShort(response, byteOffset) * -1;
-	config.ProtectionAmperage = ReadHexEncodedSShort(response, byteOffset) * -1;
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 100;
-
-	return true;
+	return DecodeConfiguration(busId, response, dischargeOverCurrent1ConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const DischargeOverCurrent1Configuration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.AlarmAmperage < 1 || config.AlarmAmperage > 220)
-	{
-		LogError("AlarmAmperage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionAmperage < 1 || config.ProtectionAmperage > 220)
-	{
-		LogError("ProtectionAmperage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 500 || config.ProtectionDelayMilliseconds > 25000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 500 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 500");
-		return false;
-	}
-
-	const uint16_t payloadLen = 12;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, config.AlarmAmperage);
-	WriteHexEncodedUShort(payload, payloadOffset, config.ProtectionAmperage);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 100);
-
-	CreateRequest(busId, CID2_WriteDischargeSlowOverCurrentConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteDischargeSlowOverCurrentConfiguration, dischargeOverCurrent1ConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadDishargeOverCurrent2ConfigurationRequestV25[] = "~250046E30000FD97\r";
@@ -1625,67 +1404,19 @@ const unsigned char PaceBmsProtocolV25::exampleReadDishargeOverCurrent2Configura
 const unsigned char PaceBmsProtocolV25::exampleWriteDishargeOverCurrent2ConfigurationRequestV25[] = "~250046E2A006009604FC4E\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteDishargeOverCurrent2ConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField dischargeOverCurrent2ConfigurationFields[] = {
+	ConfigurationConstant(0x00),
+	ConfigurationValue(CONFIGURATION_MEMBER(DischargeOverCurrent2Configuration, ProtectionAmperage), ConfigurationField::WIRE_BYTE, 5, 255, 5),
+	ConfigurationValue(CONFIGURATION_MEMBER(DischargeOverCurrent2Configuration, ProtectionDelayMilliseconds), ConfigurationField::WIRE_BYTE, 100, 2000, 100, 25),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, DischargeOverCurrent2Configuration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 0)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.ProtectionAmperage = ReadHexEncodedByte(response, byteOffset);
-	config.ProtectionDelayMilliseconds = ReadHexEncodedByte(response, byteOffset) * 25;
-
-	// ignore the garbage tail, likely firmware bug since it's not sent on the write
-
-	return true;
+	return DecodeConfiguration(busId, response, dischargeOverCurrent2ConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const DischargeOverCurrent2Configuration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.ProtectionAmperage < 5 || config.ProtectionAmperage > 255)
-	{
-		LogError("ProtectionAmperage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionAmperage % 5 != 0)
-	{
-		LogError("ProtectionAmperage should be in steps of 5");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds < 100 || config.ProtectionDelayMilliseconds > 2000)
-	{
-		LogError("ProtectionDelayMilliseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMilliseconds % 100 != 0)
-	{
-		LogError("ProtectionDelayMilliseconds should be in steps of 100");
-		return false;
-	}
-
-	const uint16_t payloadLen = 6;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x00);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionAmperage);
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMilliseconds / 25);
-
-	CreateRequest(busId, CID2_WriteDischargeFastOverCurrentConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteDischargeFastOverCurrentConfiguration, dischargeOverCurrent2ConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadShortCircuitProtectionConfigurationRequestV25[] = "~250046E50000FD95\r";
@@ -1693,44 +1424,17 @@ const unsigned char PaceBmsProtocolV25::exampleReadShortCircuitProtectionConfigu
 const unsigned char PaceBmsProtocolV25::exampleWriteShortCircuitProtectionConfigurationRequestV25[] = "~250046E4E0020CFD0C\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteShortCircuitProtectionConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField shortCircuitProtectionConfigurationFields[] = {
+	ConfigurationValue(CONFIGURATION_MEMBER(ShortCircuitProtectionConfiguration, ProtectionDelayMicroseconds), ConfigurationField::WIRE_BYTE, 100, 500, 50, 25),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, ShortCircuitProtectionConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	config.ProtectionDelayMicroseconds = ReadHexEncodedByte(response, byteOffset) * 25;
-
-	return true;
+	return DecodeConfiguration(busId, response, shortCircuitProtectionConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const ShortCircuitProtectionConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.ProtectionDelayMicroseconds < 100 || config.ProtectionDelayMicroseconds > 500)
-	{
-		LogError("ProtectionDelayMicroseconds is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionDelayMicroseconds % 50 != 0)
-	{
-		LogError("ProtectionDelayMicroseconds should be in steps of 50");
-		return false;
-	}
-
-	const uint16_t payloadLen = 2;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	WriteHexEncodedByte(payload, payloadOffset, config.ProtectionDelayMicroseconds / 25);
-
-	CreateRequest(busId, CID2_WriteShortCircuitProtectionConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteShortCircuitProtectionConfiguration, shortCircuitProtectionConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadCellBalancingConfigurationRequestV25[] = "~250046B60000FD97\r";
@@ -1738,51 +1442,18 @@ const unsigned char PaceBmsProtocolV25::exampleReadCellBalancingConfigurationRes
 const unsigned char PaceBmsProtocolV25::exampleWriteCellBalancingConfigurationRequestV25[] = "~250046B580080D48001EFBD2\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteCellBalancingConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField cellBalancingConfigurationFields[] = {
+	ConfigurationValue(CONFIGURATION_MEMBER(CellBalancingConfiguration, ThresholdMillivolts), ConfigurationField::WIRE_USHORT, 3300, 4500, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(CellBalancingConfiguration, DeltaCellMillivolts), ConfigurationField::WIRE_USHORT, 20, 500),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, CellBalancingConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	config.ThresholdMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.DeltaCellMillivolts = ReadHexEncodedUShort(response, byteOffset);
-
-	return true;
+	return DecodeConfiguration(busId, response, cellBalancingConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const CellBalancingConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.ThresholdMillivolts < 3300 || config.ThresholdMillivolts > 4500)
-	{
-		LogError("ThresholdVolts is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ThresholdMillivolts % 10 != 0)
-	{
-		LogError("ThresholdVolts should be in steps of 0.01");
-		return false;
-	}
-	if (config.DeltaCellMillivolts < 20 || config.DeltaCellMillivolts > 500)
-	{
-		LogError("DeltaCellMillivolts is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 8;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	WriteHexEncodedUShort(payload, payloadOffset, config.ThresholdMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.DeltaCellMillivolts);
-
-	CreateRequest(busId, CID2_WriteCellBalancingConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteCellBalancingConfiguration, cellBalancingConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadSleepConfigurationRequestV25[] = "~250046A00000FD9E\r";
@@ -1790,59 +1461,19 @@ const unsigned char PaceBmsProtocolV25::exampleReadSleepConfigurationResponseV25
 const unsigned char PaceBmsProtocolV25::exampleWriteSleepConfigurationRequestV25[] = "~250046A880080C1C0005FBDA\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteSleepConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField sleepConfigurationFields[] = {
+	ConfigurationValue(CONFIGURATION_MEMBER(SleepConfiguration, CellMillivolts), ConfigurationField::WIRE_USHORT, 2000, 4000, 10),
+	ConfigurationConstant(0x00),
+	ConfigurationValue(CONFIGURATION_MEMBER(SleepConfiguration, DelayMinutes), ConfigurationField::WIRE_BYTE, 1, 120),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, SleepConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	config.CellMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	uint8_t unknown2 = ReadHexEncodedByte(response, byteOffset);
-	config.DelayMinutes = ReadHexEncodedByte(response, byteOffset);
-
-	if (unknown2 != 0)
-	{
-		LogError("Unknown2 value in payload is not zero");
-		return false;
-	}
-
-	return true;
+	return DecodeConfiguration(busId, response, sleepConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const SleepConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.CellMillivolts < 2000 || config.CellMillivolts > 4000)
-	{
-		LogError("CellVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.CellMillivolts % 10 != 0)
-	{
-		LogError("CellVoltage should be in steps of 0.01");
-		return false;
-	}
-	if (config.DelayMinutes < 1.0f || config.DelayMinutes > 120.0f)
-	{
-		LogError("DelayMinutes is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 8;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	WriteHexEncodedUShort(payload, payloadOffset, config.CellMillivolts);
-	WriteHexEncodedByte(payload, payloadOffset, 0x00);
-	WriteHexEncodedByte(payload, payloadOffset, config.DelayMinutes);
-
-	CreateRequest(busId, CID2_WriteSleepConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteSleepConfiguration, sleepConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadFullChargeLowChargeConfigurationRequestV25[] = "~250046AF0000FD88\r";
@@ -1850,63 +1481,19 @@ const unsigned char PaceBmsProtocolV25::exampleReadFullChargeLowChargeConfigurat
 const unsigned char PaceBmsProtocolV25::exampleWriteFullChargeLowChargeConfigurationRequestV25[] = "~250046AE600ADAC007D005FB3A\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteFullChargeLowChargeConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField fullChargeLowChargeConfigurationFields[] = {
+	ConfigurationValue(CONFIGURATION_MEMBER(FullChargeLowChargeConfiguration, FullChargeMillivolts), ConfigurationField::WIRE_USHORT, 20000, 65000, 10),
+	ConfigurationValue(CONFIGURATION_MEMBER(FullChargeLowChargeConfiguration, FullChargeMilliamps), ConfigurationField::WIRE_USHORT, 500, 5000, 500),
+	ConfigurationValue(CONFIGURATION_MEMBER(FullChargeLowChargeConfiguration, LowChargeAlarmPercent), ConfigurationField::WIRE_BYTE, 0, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, FullChargeLowChargeConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	config.FullChargeMillivolts = ReadHexEncodedUShort(response, byteOffset);
-	config.FullChargeMilliamps = ReadHexEncodedUShort(response, byteOffset);
-	config.LowChargeAlarmPercent = ReadHexEncodedByte(response, byteOffset);
-
-	return true;
+	return DecodeConfiguration(busId, response, fullChargeLowChargeConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const FullChargeLowChargeConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.FullChargeMillivolts < 20000 || config.FullChargeMillivolts > 65000)
-	{
-		LogError("FullChargeVoltage is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.FullChargeMillivolts % 10 != 0)
-	{
-		LogError("FullChargeVoltage should be in steps of 0.001");
-		return false;
-	}
-	if (config.FullChargeMilliamps < 500 || config.FullChargeMilliamps > 5000)
-	{
-		LogError("FullChargeCurrentMilliamps is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.FullChargeMilliamps % 500 != 0)
-	{
-		LogError("FullChargeCurrentMilliamps should be in steps of 500");
-		return false;
-	}
-	if (config.LowChargeAlarmPercent < 0 || config.LowChargeAlarmPercent > 100)
-	{
-		LogError("LowChargeAlarmPercent is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 10;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	WriteHexEncodedUShort(payload, payloadOffset, config.FullChargeMillivolts);
-	WriteHexEncodedUShort(payload, payloadOffset, config.FullChargeMilliamps);
-	WriteHexEncodedByte(payload, payloadOffset, config.LowChargeAlarmPercent);
-
-	CreateRequest(busId, CID2_WriteFullChargeLowChargeConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteFullChargeLowChargeConfiguration, fullChargeLowChargeConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadChargeAndDischargeOverTemperatureConfigurationRequestV25[] = "~250046DD0000FD87\r";
@@ -1914,83 +1501,23 @@ const unsigned char PaceBmsProtocolV25::exampleReadChargeAndDischargeOverTempera
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeAndDischargeOverTemperatureConfigurationRequestV25[] = "~250046DC501A010CA80CD00C9E0CDA0D020CD0F797\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeAndDischargeOverTemperatureConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField chargeAndDischargeOverTemperatureConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, ChargeAlarm), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, ChargeProtection), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, ChargeProtectionRelease), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, DischargeAlarm), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, DischargeProtection), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeOverTemperatureConfiguration, DischargeProtectionRelease), 20, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, ChargeAndDischargeOverTemperatureConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.ChargeAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.ChargeProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.ChargeProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-
-	return true;
+	return DecodeConfiguration(busId, response, chargeAndDischargeOverTemperatureConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const ChargeAndDischargeOverTemperatureConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.ChargeAlarm < 20 || config.ChargeAlarm > 100)
-	{
-		LogError("ChargeAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ChargeProtection < 20 || config.ChargeProtection > 100)
-	{
-		LogError("ChargeProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ChargeProtectionRelease < 20 || config.ChargeProtectionRelease > 100)
-	{
-		LogError("ChargeProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeAlarm < 20 || config.DischargeAlarm > 100)
-	{
-		LogError("DischargeAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeProtection < 20 || config.DischargeProtection > 100)
-	{
-		LogError("DischargeProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeProtectionRelease < 20 || config.DischargeProtectionRelease > 100)
-	{
-		LogError("DischargeProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 26;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeProtectionRelease * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeProtectionRelease * 10) + 2730);
-
-	CreateRequest(busId, CID2_WriteChargeAndDischargeOverTemperatureConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteChargeAndDischargeOverTemperatureConfiguration, chargeAndDischargeOverTemperatureConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadChargeAndDischargeUnderTemperatureConfigurationRequestV25[] = "~250046DF0000FD85\r";
@@ -1998,83 +1525,23 @@ const unsigned char PaceBmsProtocolV25::exampleReadChargeAndDischargeUnderTemper
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeAndDischargeUnderTemperatureConfigurationRequestV25[] = "~250046DE501A010AAA0A780AAA0A1409E20A14F7BC\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteChargeAndDischargeUnderTemperatureConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField chargeAndDischargeUnderTemperatureConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, ChargeAlarm), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, ChargeProtection), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, ChargeProtectionRelease), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, DischargeAlarm), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, DischargeProtection), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(ChargeAndDischargeUnderTemperatureConfiguration, DischargeProtectionRelease), -35, 30),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, ChargeAndDischargeUnderTemperatureConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.ChargeAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.ChargeProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.ChargeProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.DischargeProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-
-	return true;
+	return DecodeConfiguration(busId, response, chargeAndDischargeUnderTemperatureConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const ChargeAndDischargeUnderTemperatureConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.ChargeAlarm < -35 || config.ChargeAlarm > 30)
-	{
-		LogError("ChargeAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ChargeProtection < -35 || config.ChargeProtection > 30)
-	{
-		LogError("ChargeProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ChargeProtectionRelease < -35 || config.ChargeProtectionRelease > 30)
-	{
-		LogError("ChargeProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeAlarm < -35 || config.DischargeAlarm > 30)
-	{
-		LogError("DischargeAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeProtection < -35 || config.DischargeProtection > 30)
-	{
-		LogError("DischargeProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.DischargeProtectionRelease < -35 || config.DischargeProtectionRelease > 30)
-	{
-		LogError("DischargeProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 26;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ChargeProtectionRelease * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.DischargeProtectionRelease * 10) + 2730);
-
-	CreateRequest(busId, CID2_WriteChargeAndDischargeUnderTemperatureConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteChargeAndDischargeUnderTemperatureConfiguration, chargeAndDischargeUnderTemperatureConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadMosfetOverTemperatureConfigurationRequestV25[] = "~250046E10000FD99\r";
@@ -2082,62 +1549,20 @@ const unsigned char PaceBmsProtocolV25::exampleReadMosfetOverTemperatureConfigur
 const unsigned char PaceBmsProtocolV25::exampleWriteMosfetOverTemperatureConfigurationRequestV25[] = "~250046E0200E010E2E0EF60DFCFA48\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteMosfetOverTemperatureConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField mosfetOverTemperatureConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(MosfetOverTemperatureConfiguration, Alarm), 30, 120),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(MosfetOverTemperatureConfiguration, Protection), 30, 120),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(MosfetOverTemperatureConfiguration, ProtectionRelease), 30, 120),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, MosfetOverTemperatureConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.Alarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.Protection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.ProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-
-	return true;
+	return DecodeConfiguration(busId, response, mosfetOverTemperatureConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const MosfetOverTemperatureConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.Alarm < 30 || config.Alarm > 120)
-	{
-		LogError("Alarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.Protection < 30 || config.Protection > 120)
-	{
-		LogError("Protection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.ProtectionRelease < 30 || config.ProtectionRelease > 120)
-	{
-		LogError("ProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 26;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.Alarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.Protection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.ProtectionRelease * 10) + 2730);
-
-	CreateRequest(busId, CID2_WriteMosfetOverTemperatureConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteMosfetOverTemperatureConfiguration, mosfetOverTemperatureConfigurationFields, config, request);
 }
 
 const unsigned char PaceBmsProtocolV25::exampleReadEnvironmentOverUnderTemperatureConfigurationRequestV25[] = "~250046E70000FD93\r";
@@ -2145,83 +1570,23 @@ const unsigned char PaceBmsProtocolV25::exampleReadEnvironmentOverUnderTemperatu
 const unsigned char PaceBmsProtocolV25::exampleWriteEnvironmentOverUnderTemperatureConfigurationRequestV25[] = "~250046E6501A0109E209B009E20D340D660D34F7EB\r";
 const unsigned char PaceBmsProtocolV25::exampleWriteEnvironmentOverUnderTemperatureConfigurationResponseV25[] = "~250046000000FDAF\r";
 
+static constexpr ConfigurationField environmentOverUnderTemperatureConfigurationFields[] = {
+	ConfigurationConstant(0x01),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, UnderAlarm), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, UnderProtection), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, UnderProtectionRelease), -35, 30),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, OverAlarm), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, OverProtection), 20, 100),
+	ConfigurationTemperature(CONFIGURATION_MEMBER(EnvironmentOverUnderTemperatureConfiguration, OverProtectionRelease), 20, 100),
+};
+
 bool PaceBmsProtocolV25::ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, EnvironmentOverUnderTemperatureConfiguration& config)
 {
-	int16_t payloadLen = ValidateResponseAndGetPayloadLength(busId, response);
-	if (payloadLen == -1)
-	{
-		// failed to validate, the call would have done it's own logging
-		return false;
-	}
-
-	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
-	uint16_t byteOffset = 13;
-
-	uint16_t unknown = ReadHexEncodedByte(response, byteOffset);
-	if (unknown != 01)
-	{
-		LogWarning("Unknown payload byte does not match previously observed value");
-		return false;
-	}
-
-	config.UnderAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.UnderProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.UnderProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.OverAlarm = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.OverProtection = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-	config.OverProtectionRelease = (ReadHexEncodedUShort(response, byteOffset) - 2730) / 10;
-
-	return true;
+	return DecodeConfiguration(busId, response, environmentOverUnderTemperatureConfigurationFields, config);
 }
 bool PaceBmsProtocolV25::CreateWriteConfigurationRequest(const uint8_t busId, const EnvironmentOverUnderTemperatureConfiguration& config, std::vector<uint8_t>& request)
 {
-	// validate values conform to what PBmsTools would send
-	if (config.UnderAlarm < -35 || config.UnderAlarm > 30)
-	{
-		LogError("UnderAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.UnderProtection < -35 || config.UnderProtection > 30)
-	{
-		LogError("UnderProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.UnderProtectionRelease < -35 || config.UnderProtectionRelease > 30)
-	{
-		LogError("UnderProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.OverAlarm < 20 || config.OverAlarm > 100)
-	{
-		LogError("OverAlarm is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.OverProtection < 20 || config.OverProtection > 100)
-	{
-		LogError("OverProtection is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-	if (config.OverProtectionRelease < 20 || config.OverProtectionRelease > 100)
-	{
-		LogError("OverProtectionRelease is not in the range that PBmsTools would send (or expect back)");
-		return false;
-	}
-
-	const uint16_t payloadLen = 26;
-	std::vector<uint8_t> payload(payloadLen);
-	uint16_t payloadOffset = 0;
-	// unknown value
-	WriteHexEncodedByte(payload, payloadOffset, 0x01);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.UnderAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.UnderProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.UnderProtectionRelease * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.OverAlarm * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.OverProtection * 10) + 2730);
-	WriteHexEncodedUShort(payload, payloadOffset, (config.OverProtectionRelease * 10) + 2730);
-
-	CreateRequest(busId, CID2_WriteEnvironmentOverUnderTemperatureConfiguration, payload, request);
-
-	return true;
+	return EncodeConfiguration(busId, CID2_WriteEnvironmentOverUnderTemperatureConfiguration, environmentOverUnderTemperatureConfigurationFields, config, request);
 }
 
 // ============================================================================
@@ -2295,8 +1660,7 @@ bool PaceBmsProtocolV25::ProcessWriteChargeCurrentLimiterStartCurrentResponse(co
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Documentation indicates a write charge current limiter start current response should return no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Documentation indicates a write charge current limiter start current response should return no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
@@ -2323,12 +1687,28 @@ bool PaceBmsProtocolV25::ProcessReadRemainingCapacityResponse(const uint8_t busI
 	// payload starts here, everything else was validated by the initial call to ValidateResponseAndGetPayloadLength
 	uint16_t byteOffset = 13;
 
+	if (payloadLen != 12)
+	{
+		LogError("Documentation indicates a remaining capacity response should return a 12 byte payload, but this response's payload length is %i", payloadLen);
+		return false;
+	}
+
 	remainingCapacityMilliampHours = ReadHexEncodedUShort(response, byteOffset) * 10;
 	actualCapacityMilliampHours = ReadHexEncodedUShort(response, byteOffset) * 10;
 	designCapacityMilliampHours = ReadHexEncodedUShort(response, byteOffset) * 10;
 
 	return true;
 }
+bool PaceBmsProtocolV25::ProcessReadRemainingCapacityResponse(const uint8_t busId, const std::vector<uint8_t>& response, RemainingCapacity& remainingCapacity)
+{
+	if (!ProcessReadRemainingCapacityResponse(busId, response, remainingCapacity.remainingCapacityMilliampHours, remainingCapacity.fullCapacityMilliampHours, remainingCapacity.designCapacityMilliampHours))
+		return false;
+
+	remainingCapacity.SoCHundredthsPercent = CalculateHundredthsPercent(remainingCapacity.remainingCapacityMilliampHours, remainingCapacity.fullCapacityMilliampHours);
+	remainingCapacity.SoHHundredthsPercent = CalculateHundredthsPercent(remainingCapacity.fullCapacityMilliampHours, remainingCapacity.designCapacityMilliampHours);
+
+	return true;
+}
 
 const unsigned char PaceBmsProtocolV25::exampleReadProtocolsRequestV25[] = "~250046EB0000FD88\r";
 const unsigned char PaceBmsProtocolV25::exampleReadProtocolsResponseV25[] = "~25004600A006131400FC6F\r";
@@ -2382,8 +1762,7 @@ bool PaceBmsProtocolV25::ProcessWriteProtocolsResponse(const uint8_t busId, cons
 
 	if (payloadLen != 0)
 	{
-		std::string message = std::string("Write protocols response should include no payload, but this response's payload length is ") + std::to_string(payloadLen);
-		LogError(message);
+		LogError("Write protocols response should include no payload, but this response's payload length is %i", payloadLen);
 		return false;
 	}
 
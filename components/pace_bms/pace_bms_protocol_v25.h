@@ -11,13 +11,10 @@ public:
 		CID1_LithiumIon = 0x4F,  // not used by PBmsTools 2.4, but reported by someone using a rebadged version of it on a 14s 48v pack which also exposes protocol version 0x25
 	};
 
-	// dependency injection
-	typedef void (*LogFuncPtr)(std::string message);
-
-	// takes pointers to the "real" logging functions
+	// takes a pointer to the "real" logging function
 	PaceBmsProtocolV25(
 		OPTIONAL_NS::optional<std::string> protocol_variant, OPTIONAL_NS::optional<uint8_t> protocol_version_override, OPTIONAL_NS::optional<uint8_t> batteryChemistry,
-		LogFuncPtr logError, LogFuncPtr logWarning, LogFuncPtr logInfo, LogFuncPtr logDebug, LogFuncPtr logVerbose, LogFuncPtr logVeryVerbose);
+		LogFuncPtr log);
 
 protected:
 	int16_t AnalogInformationUserDefinedValue = -1;
@@ -131,9 +128,9 @@ public:
 		uint16_t cycleCount{ 0 };
 		uint32_t designCapacityMilliampHours{ 0 };
 		// calculated
-		float    SoC{ 0 }; // in percent
-		float    SoH{ 0 }; // in percent
-		float    powerWatts{ 0 };
+		uint16_t SoCHundredthsPercent{ 0 };
+		uint16_t SoHHundredthsPercent{ 0 };
+		int32_t  powerMilliwatts{ 0 };
 		uint16_t minCellVoltageMillivolts{ 0 };
 		uint16_t maxCellVoltageMillivolts{ 0 };
 		uint16_t avgCellVoltageMillivolts{ 0 };
@@ -614,6 +611,60 @@ public:
 	bool CreateReadConfigurationRequest(const uint8_t busId, const ReadConfigurationType configType, std::vector<uint8_t>& request);
 	bool ProcessWriteConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response);
 
+	// every configuration below is a short run of fixed width values, so rather than each overload hand-writing its own 
+	// decode / validate / encode, each is described by a constexpr table of these (in the .cpp, next to the overloads) 
+	// and run through the one generic decoder and encoder
+	struct ConfigurationField
+	{
+		enum Wire : uint8_t
+		{
+			WIRE_BYTE,
+			WIRE_USHORT,
+			// returned as the negative two's complement, but STORED (written back) as the normal positive value
+			WIRE_NEGATED_SSHORT,
+		};
+		enum Storage : uint8_t
+		{
+			// not in the struct, a byte with a fixed value (min) that is checked on read and sent on write
+			STORAGE_CONSTANT,
+			STORAGE_UINT8,
+			STORAGE_INT8,
+			STORAGE_UINT16,
+		};
+
+		// for log messages
+		const char* name;
+		// where the value lives in the configuration struct
+		uint8_t offset;
+		Storage storage;
+		Wire wire;
+		// on the wire as (value * scale / unit) + bias, e.g. a delay stored in 100ms steps has a unit of 100
+		uint8_t scale;
+		uint8_t unit;
+		uint16_t bias;
+		// what PBmsTools would send (or expect back), a step of 0 allows any value in the range
+		int32_t min;
+		int32_t max;
+		uint16_t step;
+	};
+
+protected:
+	bool DecodeConfiguration(const uint8_t busId, const std::vector<uint8_t>& response, const ConfigurationField* fields, const uint8_t fieldCount, void* config);
+	bool EncodeConfiguration(const uint8_t busId, const CID2 cid2, const ConfigurationField* fields, const uint8_t fieldCount, const void* config, std::vector<uint8_t>& request);
+	// these only pick up the table's length, so there's one copy of the actual decoder / encoder in flash
+	template<typename T, size_t N>
+	bool DecodeConfiguration(const uint8_t busId, const std::vector<uint8_t>& response, const ConfigurationField (&fields)[N], T& config)
+	{
+		return DecodeConfiguration(busId, response, fields, N, &config);
+	}
+	template<typename T, size_t N>
+	bool EncodeConfiguration(const uint8_t busId, const CID2 cid2, const ConfigurationField (&fields)[N], const T& config, std::vector<uint8_t>& request)
+	{
+		return EncodeConfiguration(busId, cid2, fields, N, &config, request);
+	}
+
+public:
+
 	// ==== Cell Over Voltage Configuration
 	// 1 Cell OV Alarm (V): 3.60 - stored as v * 1000, so 3.6 is 3600 - valid range reported by PBmsTools as 2.5-4.5 in steps of 0.01
 	// 2 Cell OV Protect (V): 3.70 - stored as v * 1000, so 3.7 is 3700 - valid range reported by PBmsTools as 2.5-4.5 in steps of 0.01
@@ -665,7 +716,7 @@ public:
 		uint16_t ProtectionDelayMilliseconds;
 	};
 
-	bool ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t> response, PackOverVoltageConfiguration& config);
+	bool ProcessReadConfigurationResponse(const uint8_t busId, const std::vector<uint8_t>& response, PackOverVoltageConfiguration& config);
 	bool CreateWriteConfigurationRequest(const uint8_t busId, const PackOverVoltageConfiguration& config, std::vector<uint8_t>& request);
 
 	// ==== Cell Under Voltage Configuration
@@ -1043,11 +1094,24 @@ public:
 	// resp:  ~25004600400C183C286A2710FB0E.
 	//                     111122223333
 
+	// this is a subset of the analog information (the capacities there are the same values) in a response about a tenth the size,
+	// so it can be polled often to keep SoC fresh without reading the whole analog information every time
 	static const uint8_t exampleReadRemainingCapacityRequestV25[];
 	static const uint8_t exampleReadRemainingCapacityResponseV25[];
 
+	struct RemainingCapacity
+	{
+		uint32_t remainingCapacityMilliampHours{ 0 };
+		uint32_t fullCapacityMilliampHours{ 0 };
+		uint32_t designCapacityMilliampHours{ 0 };
+		// calculated, the same way as AnalogInformation
+		uint16_t SoCHundredthsPercent{ 0 };
+		uint16_t SoHHundredthsPercent{ 0 };
+	};
+
 	bool CreateReadRemainingCapacityRequest(const uint8_t busId, std::vector<uint8_t>& request);
 	bool ProcessReadRemainingCapacityResponse(const uint8_t busId, const std::vector<uint8_t>& response, uint32_t& remainingCapacityMilliampHours, uint32_t& actualCapacityMilliampHours, uint32_t& designCapacityMilliampHours);
+	bool ProcessReadRemainingCapacityResponse(const uint8_t busId, const std::vector<uint8_t>& response, RemainingCapacity& remainingCapacity);
 
 	// ==== Protocol
 	// 1 - CAN protocol, see enum, this example is "AFORE"
@@ -0,0 +1,37 @@
+#include <cstring>
+
+#include "pace_bms_proxy_cache.h"
+
+namespace esphome {
+namespace pace_bms {
+
+const std::vector<uint8_t>* PaceBmsProxyCache::lookup(const uint8_t* request, size_t request_length, uint32_t now, uint32_t ttl, uint32_t* age) const {
+	for (const entry& entry : this->entries_) {
+		if (entry.request_.size() != request_length || memcmp(entry.request_.data(), request, request_length) != 0)
+			continue;
+		// wrap-safe, millis() rolls over every ~49 days
+		if (now - entry.received_ >= ttl)
+			return nullptr;
+		if (age != nullptr)
+			*age = now - entry.received_;
+		return &entry.response_;
+	}
+	return nullptr;
+}
+
+void PaceBmsProxyCache::store(const std::vector<uint8_t>& request, const uint8_t* response, size_t response_length, bool add, uint32_t now) {
+	if (request.empty())
+		return;
+	for (entry& entry : this->entries_) {
+		if (entry.request_ == request) {
+			entry.response_.assign(response, response + response_length);
+			entry.received_ = now;
+			return;
+		}
+	}
+	if (add)
+		this->entries_.push_back({ request, std::vector<uint8_t>(response, response + response_length), now });
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace pace_bms {
+
+/*
+* The most recent good response to each read the hub sends itself, keyed by the exact request frame, so a proxy client
+* making the same request can be answered without going to the pack.
+*
+* Only requests the hub has made itself get an entry, a response is otherwise only used to refresh one that's already
+* there (say a client's request for an entry that had expired), since there's no telling whether anything else is a
+* read that's safe to answer again.  Deciding which responses are good enough to keep is up to the owner.
+*
+* There are only ever a couple dozen entries so a linear scan is all this needs.
+*
+* This has no esphome dependencies (time is passed in) so it can be exercised off-device.
+*/
+class PaceBmsProxyCache {
+public:
+	// the response stored against this exact request frame if it's younger than ttl, null otherwise
+	const std::vector<uint8_t>* lookup(const uint8_t* request, size_t request_length, uint32_t now, uint32_t ttl, uint32_t* age = nullptr) const;
+	// refreshes the entry for request with response, or adds one if there isn't one yet and add is set
+	void store(const std::vector<uint8_t>& request, const uint8_t* response, size_t response_length, bool add, uint32_t now);
+
+	size_t size() const { return this->entries_.size(); }
+
+protected:
+	struct entry
+	{
+		std::vector<uint8_t> request_;
+		std::vector<uint8_t> response_;
+		uint32_t received_;
+	};
+	std::vector<entry> entries_;
+};
+
+}  // namespace pace_bms
+}  // namespace esphome
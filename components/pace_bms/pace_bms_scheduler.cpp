@@ -0,0 +1,182 @@
+#include <algorithm>
+
+#include "pace_bms_scheduler.h"
+
+namespace esphome {
+namespace pace_bms {
+
+PaceBmsScheduler::~PaceBmsScheduler() {
+	for (command_item* item : this->next_)
+		delete item;
+	for (command_item* item : this->queue_)
+		delete item;
+}
+
+void PaceBmsScheduler::push(command_item* item, Priority priority, uint32_t now, uint32_t relative_deadline) {
+	item->priority_ = priority;
+	item->queued_ = now;
+	item->deadline_ = now + relative_deadline;
+	item->period_ = relative_deadline;
+	this->queue_.push_back(item);
+}
+
+void PaceBmsScheduler::push_with_deduplication(command_item* item, Priority priority, uint32_t now, uint32_t relative_deadline) {
+	auto iter = std::find_if(this->queue_.begin(), this->queue_.end(),
+		[&item](const command_item* test) -> bool {
+			return test->description_ == item->description_;
+		});
+
+	if (iter != this->queue_.end()) {
+		// keep the original's place in line
+		item->priority_ = (*iter)->priority_;
+		item->queued_ = (*iter)->queued_;
+		item->deadline_ = (*iter)->deadline_;
+		item->period_ = (*iter)->period_;
+		std::swap((*iter), item);
+		delete item;
+	}
+	else {
+		this->push(item, priority, now, relative_deadline);
+	}
+}
+
+void PaceBmsScheduler::push_next(command_item* item, Priority priority, uint32_t now) {
+	item->priority_ = priority;
+	item->queued_ = now;
+	item->deadline_ = now;
+	this->next_.push_front(item);
+}
+
+bool PaceBmsScheduler::contains(const std::string& description) const {
+	for (const std::list<command_item*>* list : { &this->next_, &this->queue_ })
+		for (const command_item* item : *list)
+			if (item->description_ == description)
+				return true;
+	return false;
+}
+
+size_t PaceBmsScheduler::drop_reads() {
+	size_t count = 0;
+	for (std::list<command_item*>* list : { &this->next_, &this->queue_ }) {
+		for (auto iter = list->begin(); iter != list->end();) {
+			if ((*iter)->priority_ == PRIORITY_WRITE) {
+				iter++;
+				continue;
+			}
+			delete *iter;
+			iter = list->erase(iter);
+			count++;
+		}
+	}
+	return count;
+}
+
+size_t PaceBmsScheduler::get_write_count() const {
+	size_t count = 0;
+	for (const command_item* item : this->next_)
+		count += item->priority_ == PRIORITY_WRITE;
+	for (const command_item* item : this->queue_)
+		count += item->priority_ == PRIORITY_WRITE;
+	return count;
+}
+
+uint8_t PaceBmsScheduler::lateness_(const command_item* item, uint32_t now) {
+	if (!before_(item->deadline_, now))
+		return 0;
+	return now - item->deadline_ >= item->period_ ? 2 : 1;
+}
+
+bool PaceBmsScheduler::more_urgent_(const command_item* a, const command_item* b, uint32_t now) {
+	uint8_t a_late = lateness_(a, now);
+	uint8_t b_late = lateness_(b, now);
+	// very late beats late beats on time, and among the (only a bit) late the more important class goes first
+	if (a_late != b_late)
+		return a_late > b_late;
+	if (a_late == 1 && a->priority_ != b->priority_)
+		return a->priority_ < b->priority_;
+	if (a->deadline_ != b->deadline_)
+		return before_(a->deadline_, b->deadline_);
+	return a->priority_ < b->priority_;
+}
+
+PaceBmsScheduler::command_item* PaceBmsScheduler::pop(uint32_t now, uint8_t mask) {
+	for (auto iter = this->next_.begin(); iter != this->next_.end(); iter++) {
+		if ((mask & priority_mask((*iter)->priority_)) == 0)
+			continue;
+		command_item* item = *iter;
+		this->next_.erase(iter);
+		// these jump the queue on purpose, they can't be late
+		item->deadline_ = now;
+		this->account_(item, now, mask);
+		return item;
+	}
+
+	// the write burst guard just takes writes out of the running for this one grant, if there's a read to send instead
+	bool skip_writes = false;
+	if (this->consecutive_writes_ >= this->max_consecutive_writes_) {
+		for (const command_item* item : this->queue_) {
+			if (item->priority_ != PRIORITY_WRITE && (mask & priority_mask(item->priority_)) != 0) {
+				skip_writes = true;
+				break;
+			}
+		}
+	}
+
+	// strict comparison keeps FIFO order among equals
+	auto best = this->queue_.end();
+	for (auto iter = this->queue_.begin(); iter != this->queue_.end(); iter++) {
+		if ((mask & priority_mask((*iter)->priority_)) == 0)
+			continue;
+		if (skip_writes && (*iter)->priority_ == PRIORITY_WRITE)
+			continue;
+		if (best == this->queue_.end() || more_urgent_(*iter, *best, now))
+			best = iter;
+	}
+	if (best == this->queue_.end())
+		return nullptr;
+
+	command_item* item = *best;
+	this->queue_.erase(best);
+	this->account_(item, now, mask);
+	return item;
+}
+
+void PaceBmsScheduler::account_(command_item* item, uint32_t now, uint8_t mask) {
+	// a read going out on another bus that doesn't carry writes doesn't give the reads waiting behind the writes a turn
+	if (item->priority_ == PRIORITY_WRITE)
+		this->consecutive_writes_++;
+	else if ((mask & priority_mask(PRIORITY_WRITE)) != 0)
+		this->consecutive_writes_ = 0;
+
+	Statistics& statistics = this->statistics_[item->priority_];
+	statistics.granted++;
+	if (before_(item->deadline_, now)) {
+		statistics.missed++;
+		statistics.worst_lateness = std::max(statistics.worst_lateness, now - item->deadline_);
+	}
+}
+
+uint32_t PaceBmsScheduler::get_missed_count() const {
+	uint32_t missed = 0;
+	for (const Statistics& statistics : this->statistics_)
+		missed += statistics.missed;
+	return missed;
+}
+
+const char* PaceBmsScheduler::get_priority_name(Priority priority) {
+	switch (priority) {
+	case PRIORITY_PROTECTION:
+		return "protection";
+	case PRIORITY_WRITE:
+		return "write";
+	case PRIORITY_INFORMATION:
+		return "information";
+	case PRIORITY_CONFIGURATION:
+		return "configuration";
+	default:
+		return "unknown";
+	}
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
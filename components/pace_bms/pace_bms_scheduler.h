@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace pace_bms {
+
+/*
+* Decides which queued command gets the bus next.
+*
+* Every command is queued with a priority class and an absolute deadline (when it was queued plus how long it may wait,
+* normally its refresh period).  The bus is granted earliest-deadline-first, with some guards on top:
+*   - anything already past its deadline goes before anything that isn't, most important class first, so a late
+*     analog/status read is never stuck behind a configuration read that still has time to spare
+*   - but once something is a whole period (its relative deadline) late, class no longer protects anything ahead of it,
+*     it competes on deadline alone, so a configuration read on a saturated bus still gets out eventually
+*   - at most max_consecutive_writes_ writes are granted in a row while reads are waiting, so a user bulk-editing
+*     configuration can't hold off the reads indefinitely
+* More than one bus can be run off the same queue by passing each bus's set of priority classes to pop().
+* A command keeps its deadline while it waits, and the owner is expected to not queue a second copy of a read that's
+* still waiting (see contains(), the owner also has to check whatever it has already popped), so a command that keeps
+* getting passed over only becomes more urgent.  Because deadlines are finite and only move forward, it always ends up
+* with the earliest deadline eventually, nothing can starve.
+*
+* There are only ever a couple dozen commands queued so a linear scan of a list is all this needs.
+*
+* This has no esphome dependencies (time is passed in) so it can be exercised off-device.
+*/
+class PaceBmsScheduler {
+public:
+	// lower value is more important, this is only the tie-breaker, deadlines come first
+	enum Priority : uint8_t
+	{
+		// analog and status information, the values automations act on
+		PRIORITY_PROTECTION = 0,
+		// user initiated writes
+		PRIORITY_WRITE = 1,
+		// hardware version, serial number, date/time
+		PRIORITY_INFORMATION = 2,
+		// BMS configuration, rarely changes
+		PRIORITY_CONFIGURATION = 3,
+		PRIORITY_COUNT = 4,
+	};
+
+	// each item points to:
+	//     a description of what is happening such as "Read Analog Information" for logging purposes
+	//     a function pointer that will generate the request frame (to avoid holding the memory prior to it being required)
+	//     a function pointer that will process the response frame and dispatch the results to any child sensors registered via the callback vectors
+	struct command_item
+	{
+		std::string description_;
+		std::function<bool(std::vector<uint8_t>&)> create_request_frame_;
+		std::function<void(std::vector<uint8_t>&)> process_response_frame_;
+		// a request frame that never changes, owned elsewhere, sent as is instead of calling create_request_frame_ if set
+		const std::vector<uint8_t>* request_frame_{ nullptr };
+		// whether it's sent again after a timeout or a damaged response, and how many times it's been sent so far
+		bool retry_{ true };
+		uint8_t attempts_{ 0 };
+		// false for a request that isn't this hub's own (one forwarded for a proxy client, an address scan probe), whose 
+		//     answer or silence says nothing about whether the owner's pack is there
+		bool own_request_{ true };
+		// filled in by the scheduler
+		Priority priority_{ PRIORITY_PROTECTION };
+		uint32_t queued_{ 0 };
+		uint32_t deadline_{ 0 };
+		uint32_t period_{ 0 };
+	};
+
+	// per priority class, since boot
+	struct Statistics
+	{
+		uint32_t granted{ 0 };
+		uint32_t missed{ 0 };
+		uint32_t worst_lateness{ 0 };
+	};
+
+	~PaceBmsScheduler();
+
+	// takes ownership of item, relative_deadline is how long it may wait from now
+	void push(command_item* item, Priority priority, uint32_t now, uint32_t relative_deadline);
+	// as push, but if a command with the same description is already waiting its content is replaced and it keeps its
+	//     place, for when multiple writes are requested due to fast UX interaction
+	void push_with_deduplication(command_item* item, Priority priority, uint32_t now, uint32_t relative_deadline);
+	// granted before anything else regardless of deadline, e.g. to read back a value immediately after writing it
+	void push_next(command_item* item, Priority priority, uint32_t now);
+
+	// a set of priority classes, for a bus that only carries some of them
+	static uint8_t priority_mask(Priority priority) { return 1 << priority; }
+	static const uint8_t ALL_PRIORITIES = 0xFF;
+
+	// removes and returns the command that should get the bus now (caller takes ownership), null if there's nothing
+	//     queued in the priority classes in mask
+	command_item* pop(uint32_t now, uint8_t mask = ALL_PRIORITIES);
+
+	// true if a command with this description is waiting, in either list
+	bool contains(const std::string& description) const;
+	// deletes every read waiting, leaving only the writes, returns how many were dropped
+	size_t drop_reads();
+
+	bool empty() const { return this->next_.empty() && this->queue_.empty(); }
+	size_t size() const { return this->next_.size() + this->queue_.size(); }
+	size_t get_read_count() const { return this->size() - this->get_write_count(); }
+	size_t get_write_count() const;
+
+	void set_max_consecutive_writes(uint8_t max_consecutive_writes) { this->max_consecutive_writes_ = max_consecutive_writes; }
+
+	const Statistics& get_statistics(Priority priority) const { return this->statistics_[priority]; }
+	uint32_t get_missed_count() const;
+	static const char* get_priority_name(Priority priority);
+
+protected:
+	std::list<command_item*> next_;
+	std::list<command_item*> queue_;
+
+	uint8_t max_consecutive_writes_{ 4 };
+	uint8_t consecutive_writes_{ 0 };
+
+	Statistics statistics_[PRIORITY_COUNT];
+
+	// wrap-safe, millis() rolls over every ~49 days
+	static bool before_(uint32_t a, uint32_t b) { return (int32_t) (a - b) < 0; }
+	// true if a should be granted before b
+	static bool more_urgent_(const command_item* a, const command_item* b, uint32_t now);
+	// 0 on time, 1 late, 2 more than a whole period late
+	static uint8_t lateness_(const command_item* item, uint32_t now);
+	void account_(command_item* item, uint32_t now, uint8_t mask);
+};
+
+}  // namespace pace_bms
+}  // namespace esphome
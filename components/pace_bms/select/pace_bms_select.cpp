@@ -12,6 +12,10 @@ static const char* const TAG = "pace_bms.select";
 void PaceBmsSelect::setup() {
 	if (this->parent_->get_protocol_commandset() == 0x25) {
 		if (this->charge_current_limiter_gear_select_ != nullptr) {
+			this->parent_->register_stale_callback([this](PaceBms::DataGroup group) {
+				if (group == PaceBms::DATA_GROUP_STATUS_INFORMATION && this->charge_current_limiter_gear_select_ != nullptr)
+					this->parent_->queue_sensor_update([this]() { this->charge_current_limiter_gear_select_->set_stale(true); });
+			});
 			this->parent_->register_status_information_callback_v25([this](PaceBmsProtocolV25::StatusInformation& status_information) {
 				if (this->charge_current_limiter_gear_select_ != nullptr) {
 					std::string state = this->charge_current_limiter_gear_select_->option_from_value(
@@ -20,7 +24,10 @@ void PaceBmsSelect::setup() {
 							PaceBmsProtocolV25::SC_SetChargeCurrentLimiterCurrentLimitHighGear :
 							PaceBmsProtocolV25::SC_SetChargeCurrentLimiterCurrentLimitLowGear));
 					ESP_LOGV(TAG, "'charge_current_limiter_gear': Publishing state due to update from the hardware: %s", state.c_str());
-					this->parent_->queue_sensor_update([this, value = state]() { this->charge_current_limiter_gear_select_->publish_state(value); });
+					this->parent_->queue_sensor_update([this, value = state]() {
+						this->charge_current_limiter_gear_select_->set_stale(false);
+						this->charge_current_limiter_gear_select_->publish_state(value);
+					});
 				}
 			});
 		}
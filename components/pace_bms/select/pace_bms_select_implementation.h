@@ -20,6 +20,11 @@ public:
 	uint8_t value_from_option(std::string str);
 	std::string option_from_value(uint8_t number);
 
+	// only a valid option can be published, so one that's gone stale keeps showing the last one and this is set 
+	//     instead, for lambdas to check before acting on it
+	bool is_stale() const { return this->stale_; }
+	void set_stale(bool stale) { this->stale_ = stale; }
+
 protected:
 	// the primary purpose of this class is to simply fill in this pure virtual and call the parent container component on user initiated state change request
 	void control(const std::string& text) override;
@@ -27,6 +32,8 @@ protected:
 	CallbackManager<void(const std::string&, uint8_t value)> control_callback_{};
 
 	std::vector<uint8_t> values_;
+
+	bool stale_{ false };
 };
 
 }  // namespace pace_bms
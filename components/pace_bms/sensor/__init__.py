@@ -10,13 +10,18 @@ from esphome.const import (
     DEVICE_CLASS_ENERGY,
     DEVICE_CLASS_POWER,
     DEVICE_CLASS_ENERGY_STORAGE,
+    DEVICE_CLASS_DURATION,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     UNIT_VOLT,
     UNIT_CELSIUS,
     UNIT_AMPERE,
     #UNIT_AMP_HOURS,   <--------- added to const.py but need to check in
     UNIT_WATT,
+    UNIT_WATT_HOURS,
     UNIT_PERCENT,
+    UNIT_SECOND,
 )
 from .. import pace_bms_ns, CONF_PACE_BMS_ID, PaceBms
 
@@ -27,6 +32,9 @@ CODEOWNERS = ["@nkinnan"]
 DEPENDENCIES = ["pace_bms"]
 
 PaceBmsSensor = pace_bms_ns.class_("PaceBmsSensor", cg.Component)
+PaceBmsSensorStatistics = pace_bms_ns.class_("PaceBmsSensorStatistics")
+StatisticsSource = PaceBmsSensorStatistics.enum("Source")
+PaceBmsSensorEnergy = pace_bms_ns.class_("PaceBmsSensorEnergy")
 
 CONF_CELL_COUNT = "cell_count"
 CONF_CELL_VOLTAGE_01 = "cell_voltage_01"
@@ -180,6 +188,133 @@ CONF_CURRENT_EVENT_VALUE      = "current_event_value"
 CONF_REMAINING_CAPACITY_VALUE = "remaining_capacity_value"
 CONF_FET_STATUS_VALUE         = "fet_status_value"
 
+######## bus scheduler diagnostics
+CONF_MISSED_DEADLINES            = "missed_deadlines"
+CONF_PROTECTION_MISSED_DEADLINES = "protection_missed_deadlines"
+CONF_BUS_UTILISATION             = "bus_utilisation"
+CONF_NODE_BUS_UTILISATION        = "node_bus_utilisation"
+CONF_RESPONSE_TIMEOUTS           = "response_timeouts"
+CONF_CORRUPT_RESPONSES           = "corrupt_responses"
+CONF_REQUEST_RETRIES             = "request_retries"
+CONF_FAILED_REQUESTS             = "failed_requests"
+
+######## how long ago each data group was last received
+CONF_ANALOG_INFORMATION_AGE = "analog_information_age"
+CONF_STATUS_INFORMATION_AGE = "status_information_age"
+CONF_CONFIGURATION_AGE      = "configuration_age"
+
+######## windowed statistics, computed on-device from the analog information
+CONF_STATISTICS = "statistics"
+CONF_SOURCE     = "source"
+CONF_INDEX      = "index"
+CONF_WINDOW     = "window"
+CONF_MIN        = "min"
+CONF_MAX        = "max"
+CONF_MEAN       = "mean"
+CONF_VARIANCE   = "variance"
+CONF_STDDEV     = "stddev"
+
+STATISTICS_SOURCES = {
+    "cell_voltage": StatisticsSource.SOURCE_CELL_VOLTAGE,
+    "all_cell_voltages": StatisticsSource.SOURCE_ALL_CELL_VOLTAGES,
+    "temperature": StatisticsSource.SOURCE_TEMPERATURE,
+    "current": StatisticsSource.SOURCE_CURRENT,
+    "total_voltage": StatisticsSource.SOURCE_TOTAL_VOLTAGE,
+    "power": StatisticsSource.SOURCE_POWER,
+    "max_cell_differential": StatisticsSource.SOURCE_MAX_CELL_DIFFERENTIAL,
+}
+
+def validate_statistics(config):
+    source = config[CONF_SOURCE]
+    if source == "cell_voltage":
+        if CONF_INDEX not in config:
+            raise cv.Invalid("index (1-16) is required when source is cell_voltage")
+        if config[CONF_INDEX] > 16:
+            raise cv.Invalid("index must be 1-16 when source is cell_voltage")
+    elif source == "temperature":
+        if CONF_INDEX not in config:
+            raise cv.Invalid("index (1-6) is required when source is temperature")
+        if config[CONF_INDEX] > 6:
+            raise cv.Invalid("index must be 1-6 when source is temperature")
+    elif CONF_INDEX in config:
+        raise cv.Invalid(f"index is only valid when source is cell_voltage or temperature, not {source}")
+    if not any(key in config for key in (CONF_MIN, CONF_MAX, CONF_MEAN, CONF_VARIANCE, CONF_STDDEV)):
+        raise cv.Invalid("at least one of min, max, mean, variance or stddev must be specified")
+    return config
+
+STATISTICS_SENSOR_SCHEMA = sensor.sensor_schema(
+    accuracy_decimals=3,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+
+######## coulomb / energy counters, integrated on-device from current and total voltage
+CONF_ENERGY              = "energy"
+CONF_SAVE_INTERVAL       = "save_interval"
+CONF_MAX_GAP             = "max_gap"
+CONF_CHARGED_CAPACITY    = "charged_capacity"
+CONF_DISCHARGED_CAPACITY = "discharged_capacity"
+CONF_CHARGED_ENERGY      = "charged_energy"
+CONF_DISCHARGED_ENERGY   = "discharged_energy"
+
+ENERGY_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(PaceBmsSensorEnergy),
+            cv.Optional(CONF_SAVE_INTERVAL, default="15min"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(minutes=1)),
+            ),
+            cv.Optional(CONF_MAX_GAP, default="5min"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_CHARGED_CAPACITY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_AMP_HOURS,
+                accuracy_decimals=3,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_DISCHARGED_CAPACITY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_AMP_HOURS,
+                accuracy_decimals=3,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_CHARGED_ENERGY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_WATT_HOURS,
+                accuracy_decimals=1,
+                device_class=DEVICE_CLASS_ENERGY,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+            cv.Optional(CONF_DISCHARGED_ENERGY): sensor.sensor_schema(
+                unit_of_measurement=UNIT_WATT_HOURS,
+                accuracy_decimals=1,
+                device_class=DEVICE_CLASS_ENERGY,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+            ),
+        }
+    ),
+    cv.has_at_least_one_key(CONF_CHARGED_CAPACITY, CONF_DISCHARGED_CAPACITY, CONF_CHARGED_ENERGY, CONF_DISCHARGED_ENERGY),
+)
+
+STATISTICS_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(PaceBmsSensorStatistics),
+            cv.Required(CONF_SOURCE): cv.enum(STATISTICS_SOURCES, lower=True),
+            cv.Optional(CONF_INDEX): cv.int_range(min=1, max=16),
+            cv.Optional(CONF_WINDOW, default="1min"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(seconds=10), max=cv.TimePeriod(hours=24)),
+            ),
+            cv.Optional(CONF_MIN): STATISTICS_SENSOR_SCHEMA,
+            cv.Optional(CONF_MAX): STATISTICS_SENSOR_SCHEMA,
+            cv.Optional(CONF_MEAN): STATISTICS_SENSOR_SCHEMA,
+            cv.Optional(CONF_VARIANCE): sensor.sensor_schema(
+                accuracy_decimals=6,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_STDDEV): STATISTICS_SENSOR_SCHEMA,
+        }
+    ),
+    validate_statistics,
+)
+
 
 CONFIG_SCHEMA = cv.Schema(
     {
@@ -740,6 +875,73 @@ CONFIG_SCHEMA = cv.Schema(
             state_class=STATE_CLASS_MEASUREMENT,
         ),
 
+        cv.Optional(CONF_MISSED_DEADLINES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_PROTECTION_MISSED_DEADLINES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_BUS_UTILISATION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_NODE_BUS_UTILISATION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_RESPONSE_TIMEOUTS): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_CORRUPT_RESPONSES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_REQUEST_RETRIES): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_FAILED_REQUESTS): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+
+        cv.Optional(CONF_ANALOG_INFORMATION_AGE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_STATUS_INFORMATION_AGE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_CONFIGURATION_AGE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+
+        cv.Optional(CONF_STATISTICS): cv.ensure_list(STATISTICS_SCHEMA),
+        cv.Optional(CONF_ENERGY): ENERGY_SCHEMA,
     }
 )
 
@@ -943,3 +1145,79 @@ async def to_code(config):
     if fet_status_value := config.get(CONF_FET_STATUS_VALUE):
         sens = await sensor.new_sensor(fet_status_value)
         cg.add(var.set_fet_status_value_sensor(sens))
+
+    if missed_deadlines := config.get(CONF_MISSED_DEADLINES):
+        sens = await sensor.new_sensor(missed_deadlines)
+        cg.add(var.set_missed_deadlines_sensor(sens))
+    if protection_missed_deadlines := config.get(CONF_PROTECTION_MISSED_DEADLINES):
+        sens = await sensor.new_sensor(protection_missed_deadlines)
+        cg.add(var.set_protection_missed_deadlines_sensor(sens))
+    if bus_utilisation := config.get(CONF_BUS_UTILISATION):
+        sens = await sensor.new_sensor(bus_utilisation)
+        cg.add(var.set_bus_utilisation_sensor(sens))
+    if node_bus_utilisation := config.get(CONF_NODE_BUS_UTILISATION):
+        sens = await sensor.new_sensor(node_bus_utilisation)
+        cg.add(var.set_node_bus_utilisation_sensor(sens))
+    if response_timeouts := config.get(CONF_RESPONSE_TIMEOUTS):
+        sens = await sensor.new_sensor(response_timeouts)
+        cg.add(var.set_response_timeouts_sensor(sens))
+    if corrupt_responses := config.get(CONF_CORRUPT_RESPONSES):
+        sens = await sensor.new_sensor(corrupt_responses)
+        cg.add(var.set_corrupt_responses_sensor(sens))
+    if request_retries := config.get(CONF_REQUEST_RETRIES):
+        sens = await sensor.new_sensor(request_retries)
+        cg.add(var.set_request_retries_sensor(sens))
+    if failed_requests := config.get(CONF_FAILED_REQUESTS):
+        sens = await sensor.new_sensor(failed_requests)
+        cg.add(var.set_failed_requests_sensor(sens))
+
+    if analog_information_age := config.get(CONF_ANALOG_INFORMATION_AGE):
+        sens = await sensor.new_sensor(analog_information_age)
+        cg.add(var.set_analog_information_age_sensor(sens))
+    if status_information_age := config.get(CONF_STATUS_INFORMATION_AGE):
+        sens = await sensor.new_sensor(status_information_age)
+        cg.add(var.set_status_information_age_sensor(sens))
+    if configuration_age := config.get(CONF_CONFIGURATION_AGE):
+        sens = await sensor.new_sensor(configuration_age)
+        cg.add(var.set_configuration_age_sensor(sens))
+
+    for statistics_config in config.get(CONF_STATISTICS, []):
+        stats = cg.new_Pvariable(statistics_config[CONF_ID])
+        cg.add(stats.set_source(statistics_config[CONF_SOURCE]))
+        if CONF_INDEX in statistics_config:
+            cg.add(stats.set_index(statistics_config[CONF_INDEX] - 1))
+        cg.add(stats.set_window(statistics_config[CONF_WINDOW]))
+        if min_config := statistics_config.get(CONF_MIN):
+            sens = await sensor.new_sensor(min_config)
+            cg.add(stats.set_min_sensor(sens))
+        if max_config := statistics_config.get(CONF_MAX):
+            sens = await sensor.new_sensor(max_config)
+            cg.add(stats.set_max_sensor(sens))
+        if mean_config := statistics_config.get(CONF_MEAN):
+            sens = await sensor.new_sensor(mean_config)
+            cg.add(stats.set_mean_sensor(sens))
+        if variance_config := statistics_config.get(CONF_VARIANCE):
+            sens = await sensor.new_sensor(variance_config)
+            cg.add(stats.set_variance_sensor(sens))
+        if stddev_config := statistics_config.get(CONF_STDDEV):
+            sens = await sensor.new_sensor(stddev_config)
+            cg.add(stats.set_stddev_sensor(sens))
+        cg.add(var.add_statistics(stats))
+
+    if energy_config := config.get(CONF_ENERGY):
+        energy = cg.new_Pvariable(energy_config[CONF_ID])
+        cg.add(energy.set_save_interval(energy_config[CONF_SAVE_INTERVAL]))
+        cg.add(energy.set_max_gap(energy_config[CONF_MAX_GAP]))
+        if charged_capacity_config := energy_config.get(CONF_CHARGED_CAPACITY):
+            sens = await sensor.new_sensor(charged_capacity_config)
+            cg.add(energy.set_charged_capacity_sensor(sens))
+        if discharged_capacity_config := energy_config.get(CONF_DISCHARGED_CAPACITY):
+            sens = await sensor.new_sensor(discharged_capacity_config)
+            cg.add(energy.set_discharged_capacity_sensor(sens))
+        if charged_energy_config := energy_config.get(CONF_CHARGED_ENERGY):
+            sens = await sensor.new_sensor(charged_energy_config)
+            cg.add(energy.set_charged_energy_sensor(sens))
+        if discharged_energy_config := energy_config.get(CONF_DISCHARGED_ENERGY):
+            sens = await sensor.new_sensor(discharged_energy_config)
+            cg.add(energy.set_discharged_energy_sensor(sens))
+        cg.add(var.set_energy(energy))
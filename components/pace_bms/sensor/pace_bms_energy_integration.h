@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace esphome {
+namespace pace_bms {
+
+// adds the area under the straight line from `from` to `to` over dt to positive and/or negative, split at the 
+//     interpolated zero crossing if the line crosses zero (a line that only touches zero at one end doesn't cross it)
+// no esphome dependencies so it can be checked off-device, see test/
+inline void integrate_split_at_zero(int32_t from, int32_t to, uint32_t dt, uint64_t& positive, uint64_t& negative) {
+	if (!((from < 0 && to > 0) || (from > 0 && to < 0))) {
+		// trapezoid, both ends on the same side of zero (or one of them at it)
+		int64_t area = ((int64_t) from + to) * dt / 2;
+		if (area >= 0)
+			positive += (uint64_t) area;
+		else
+			negative += (uint64_t) -area;
+		return;
+	}
+
+	// the linear interpolation crosses zero at t0, split into two triangles
+	int64_t magnitude_from = std::llabs((int64_t) from);
+	int64_t magnitude_to = std::llabs((int64_t) to);
+	int64_t t0 = (int64_t) dt * magnitude_from / (magnitude_from + magnitude_to);
+	uint64_t area_from = (uint64_t) (magnitude_from * t0 / 2);
+	uint64_t area_to = (uint64_t) (magnitude_to * ((int64_t) dt - t0) / 2);
+	if (from > 0) {
+		positive += area_from;
+		negative += area_to;
+	}
+	else {
+		negative += area_from;
+		positive += area_to;
+	}
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <iterator>
 
+#include "esphome/core/hal.h"
 #include "esphome/core/log.h"
 
 #include "pace_bms_sensor.h"
@@ -10,6 +14,25 @@ namespace pace_bms {
 static const char* const TAG = "pace_bms.sensor";
 
 void PaceBmsSensor::setup() {
+	if (this->energy_ != nullptr) {
+		this->energy_->setup();
+		this->set_interval("energy_save", this->energy_->get_save_interval(), [this]() { this->energy_->save(); });
+	}
+
+	if (this->missed_deadlines_sensor_ != nullptr || this->protection_missed_deadlines_sensor_ != nullptr ||
+		this->bus_utilisation_sensor_ != nullptr || this->node_bus_utilisation_sensor_ != nullptr ||
+		this->response_timeouts_sensor_ != nullptr || this->corrupt_responses_sensor_ != nullptr ||
+		this->request_retries_sensor_ != nullptr || this->failed_requests_sensor_ != nullptr) {
+		this->last_utilisation_time_ = millis();
+		this->parent_->register_scheduler_callback([this](const PaceBmsScheduler& scheduler) { this->scheduler_callback(scheduler); });
+	}
+	if (this->analog_information_age_sensor_ != nullptr || this->status_information_age_sensor_ != nullptr || this->configuration_age_sensor_ != nullptr) {
+		this->parent_->register_data_age_callback([this](PaceBms::DataGroup group, uint32_t age) { this->data_age_callback(group, age); });
+	}
+	if (request_analog_info_callback_ == true || request_status_info_callback_ == true) {
+		this->parent_->register_stale_callback([this](PaceBms::DataGroup group) { this->stale_callback(group); });
+	}
+
 	if (this->parent_->get_protocol_commandset() == 0x25) {
 		if (request_analog_info_callback_ == true) {
 			this->parent_->register_analog_information_callback_v25([this](PaceBmsProtocolV25::AnalogInformation& analog_information) { this->analog_information_callback_v25(analog_information); });
@@ -17,6 +40,12 @@ void PaceBmsSensor::setup() {
 		if (request_status_info_callback_ == true) {
 			this->parent_->register_status_information_callback_v25([this](PaceBmsProtocolV25::StatusInformation& status_information) { this->status_information_callback_v25(status_information); });
 		}
+		// only polled when the full analog information is read less often than update_interval
+		if (this->parent_->get_analog_information_interval() != 0 &&
+			(this->remaining_capacity_sensor_ != nullptr || this->full_capacity_sensor_ != nullptr || this->design_capacity_sensor_ != nullptr ||
+			 this->state_of_charge_sensor_ != nullptr || this->state_of_health_sensor_ != nullptr)) {
+			this->parent_->register_remaining_capacity_callback_v25([this](PaceBmsProtocolV25::RemainingCapacity& remaining_capacity) { this->remaining_capacity_callback_v25(remaining_capacity); });
+		}
 	}
 	else if (this->parent_->get_protocol_commandset() == 0x20) {
 		if (request_analog_info_callback_ == true) {
@@ -72,6 +101,26 @@ void PaceBmsSensor::dump_config() {
 	LOG_SENSOR("  ", "Status 3 Value", this->status3_value_sensor_);
 	LOG_SENSOR("  ", "Status 4 Value", this->status4_value_sensor_);
 	LOG_SENSOR("  ", "Status 5 Value", this->status5_value_sensor_);
+	LOG_SENSOR("  ", "Missed Deadlines", this->missed_deadlines_sensor_);
+	LOG_SENSOR("  ", "Protection Missed Deadlines", this->protection_missed_deadlines_sensor_);
+	LOG_SENSOR("  ", "Bus Utilisation", this->bus_utilisation_sensor_);
+	LOG_SENSOR("  ", "Node Bus Utilisation", this->node_bus_utilisation_sensor_);
+	LOG_SENSOR("  ", "Response Timeouts", this->response_timeouts_sensor_);
+	LOG_SENSOR("  ", "Corrupt Responses", this->corrupt_responses_sensor_);
+	LOG_SENSOR("  ", "Request Retries", this->request_retries_sensor_);
+	LOG_SENSOR("  ", "Failed Requests", this->failed_requests_sensor_);
+	LOG_SENSOR("  ", "Analog Information Age", this->analog_information_age_sensor_);
+	LOG_SENSOR("  ", "Status Information Age", this->status_information_age_sensor_);
+	LOG_SENSOR("  ", "Configuration Age", this->configuration_age_sensor_);
+	for (auto* statistics : this->statistics_)
+		statistics->dump_config();
+	if (this->energy_ != nullptr)
+		this->energy_->dump_config();
+}
+
+void PaceBmsSensor::on_shutdown() {
+	if (this->energy_ != nullptr)
+		this->energy_->save();
 }
 
 void PaceBmsSensor::analog_information_callback_v25(PaceBmsProtocolV25::AnalogInformation& analog_information) {
@@ -80,7 +129,7 @@ void PaceBmsSensor::analog_information_callback_v25(PaceBmsProtocolV25::AnalogIn
 	}
 	for (int i = 0; i < 16; i++) {
 		if (this->cell_voltage_sensor_[i] != nullptr) {
-			this->parent_->queue_sensor_update([this, i, value = analog_information.cellVoltagesMillivolts[i] / 1000.0f]() { this->cell_voltage_sensor_[i]->publish_state(value); });
+			this->parent_->queue_sensor_update([this, i, value = analog_information.cellVoltagesMillivolts[i]]() { this->cell_voltage_sensor_[i]->publish_state(value * 0.001f); });
 		}
 	}
 	if (this->temperature_count_sensor_ != nullptr) {
@@ -88,47 +137,170 @@ void PaceBmsSensor::analog_information_callback_v25(PaceBmsProtocolV25::AnalogIn
 	}
 	for (int i = 0; i < 6; i++) {
 		if (this->temperature_sensor_[i] != nullptr) {
-			this->parent_->queue_sensor_update([this, i, value = analog_information.temperaturesTenthsCelcius[i] / 10.0f]() { this->temperature_sensor_[i]->publish_state(value); });
+			this->parent_->queue_sensor_update([this, i, value = analog_information.temperaturesTenthsCelcius[i]]() { this->temperature_sensor_[i]->publish_state(value * 0.1f); });
 		}
 	}
 	if (this->current_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.currentMilliamps / 1000.0f]() { this->current_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.currentMilliamps]() { this->current_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->total_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.totalVoltageMillivolts / 1000.0f]() { this->total_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.totalVoltageMillivolts]() { this->total_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->remaining_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.remainingCapacityMilliampHours / 1000.0f]() { this->remaining_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.remainingCapacityMilliampHours]() { this->remaining_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->full_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.fullCapacityMilliampHours / 1000.0f]() { this->full_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.fullCapacityMilliampHours]() { this->full_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->design_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.designCapacityMilliampHours / 1000.0f]() { this->design_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.designCapacityMilliampHours]() { this->design_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->cycle_count_sensor_ != nullptr) {
 		this->parent_->queue_sensor_update([this, value = analog_information.cycleCount]() { this->cycle_count_sensor_->publish_state(value); });
 	}
 	if (this->state_of_charge_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.SoC]() { this->state_of_charge_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.SoCHundredthsPercent]() { this->state_of_charge_sensor_->publish_state(value * 0.01f); });
 	}
 	if (this->state_of_health_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.SoH]() { this->state_of_health_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.SoHHundredthsPercent]() { this->state_of_health_sensor_->publish_state(value * 0.01f); });
 	}
 	if (this->power_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.powerWatts]() { this->power_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.powerMilliwatts]() { this->power_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->min_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.minCellVoltageMillivolts / 1000.0f]() { this->min_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.minCellVoltageMillivolts]() { this->min_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->max_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.maxCellVoltageMillivolts / 1000.0f]() { this->max_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.maxCellVoltageMillivolts]() { this->max_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->avg_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.avgCellVoltageMillivolts / 1000.0f]() { this->avg_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.avgCellVoltageMillivolts]() { this->avg_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->max_cell_differential_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.maxCellDifferentialMillivolts / 1000.0f]() { this->max_cell_differential_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.maxCellDifferentialMillivolts]() { this->max_cell_differential_sensor_->publish_state(value * 0.001f); });
+	}
+	if (!this->statistics_.empty() || this->energy_ != nullptr) {
+		uint32_t now = millis();
+		for (auto* statistics : this->statistics_)
+			statistics->add_analog_information(this->parent_, analog_information, now);
+		if (this->energy_ != nullptr)
+			this->energy_->add_analog_information(this->parent_, analog_information, now);
+	}
+}
+
+// the missed deadline and failure counts are since boot, so these only ever go up
+void PaceBmsSensor::scheduler_callback(const PaceBmsScheduler& scheduler) {
+	if (this->missed_deadlines_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = scheduler.get_missed_count()]() { this->missed_deadlines_sensor_->publish_state(value); });
+	}
+	if (this->protection_missed_deadlines_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = scheduler.get_statistics(PaceBmsScheduler::PRIORITY_PROTECTION).missed]() { this->protection_missed_deadlines_sensor_->publish_state(value); });
+	}
+	const PaceBms::FailureCounts& failure_counts = this->parent_->get_failure_counts();
+	if (this->response_timeouts_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = failure_counts.timeouts]() { this->response_timeouts_sensor_->publish_state(value); });
+	}
+	if (this->corrupt_responses_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = failure_counts.corrupt_responses]() { this->corrupt_responses_sensor_->publish_state(value); });
+	}
+	if (this->request_retries_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = failure_counts.retries]() { this->request_retries_sensor_->publish_state(value); });
+	}
+	if (this->failed_requests_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = failure_counts.failed_requests]() { this->failed_requests_sensor_->publish_state(value); });
+	}
+
+	// percent of the time since the last update that the UARTs were busy, averaged over all of them
+	//     busy time is only counted once each request finishes, so one straddling two updates could push this a little over 100
+	uint32_t now = millis();
+	uint32_t elapsed = now - this->last_utilisation_time_;
+	this->last_utilisation_time_ = now;
+	uint64_t busy_time = this->parent_->get_busy_time();
+	uint64_t node_busy_time = PaceBms::get_node_busy_time();
+	if (this->bus_utilisation_sensor_ != nullptr && elapsed != 0) {
+		float value = (busy_time - this->last_busy_time_) * 100.0f / ((float) elapsed * this->parent_->get_link_count());
+		this->parent_->queue_sensor_update([this, value]() { this->bus_utilisation_sensor_->publish_state(std::min(value, 100.0f)); });
+	}
+	if (this->node_bus_utilisation_sensor_ != nullptr && elapsed != 0 && PaceBms::get_node_link_count() != 0) {
+		float value = (node_busy_time - this->last_node_busy_time_) * 100.0f / ((float) elapsed * PaceBms::get_node_link_count());
+		this->parent_->queue_sensor_update([this, value]() { this->node_bus_utilisation_sensor_->publish_state(std::min(value, 100.0f)); });
+	}
+	this->last_busy_time_ = busy_time;
+	this->last_node_busy_time_ = node_busy_time;
+}
+
+// in seconds, published every update
+void PaceBmsSensor::data_age_callback(PaceBms::DataGroup group, uint32_t age) {
+	sensor::Sensor* sens = nullptr;
+	switch (group) {
+	case PaceBms::DATA_GROUP_ANALOG_INFORMATION:
+		sens = this->analog_information_age_sensor_;
+		break;
+	case PaceBms::DATA_GROUP_STATUS_INFORMATION:
+		sens = this->status_information_age_sensor_;
+		break;
+	case PaceBms::DATA_GROUP_CONFIGURATION:
+		sens = this->configuration_age_sensor_;
+		break;
+	default:
+		break;
+	}
+	if (sens != nullptr) {
+		this->parent_->queue_sensor_update([sens, value = age]() { sens->publish_state(value * 0.001f); });
+	}
+}
+
+// publishing NAN shows as unavailable in home assistant, the next good response publishes real values again
+//     the windowed statistics and energy counters aren't touched, energy already refuses to integrate across a long gap
+void PaceBmsSensor::stale_callback(PaceBms::DataGroup group) {
+	std::vector<sensor::Sensor*> sensors;
+	if (group == PaceBms::DATA_GROUP_ANALOG_INFORMATION) {
+		sensors = {
+			this->cell_count_sensor_, this->temperature_count_sensor_, this->current_sensor_, this->total_voltage_sensor_,
+			this->remaining_capacity_sensor_, this->full_capacity_sensor_, this->design_capacity_sensor_, this->cycle_count_sensor_,
+			this->state_of_charge_sensor_, this->state_of_health_sensor_, this->power_sensor_, this->min_cell_voltage_sensor_,
+			this->max_cell_voltage_sensor_, this->avg_cell_voltage_sensor_, this->max_cell_differential_sensor_,
+		};
+		sensors.insert(sensors.end(), std::begin(this->cell_voltage_sensor_), std::end(this->cell_voltage_sensor_));
+		sensors.insert(sensors.end(), std::begin(this->temperature_sensor_), std::end(this->temperature_sensor_));
+	}
+	else if (group == PaceBms::DATA_GROUP_STATUS_INFORMATION) {
+		sensors = {
+			this->warning_status_value_charge_current_sensor_, this->warning_status_value_total_voltage_sensor_, this->warning_status_value_discharge_current_sensor_,
+			this->warning_status_value_1_sensor_, this->warning_status_value_2_sensor_, this->balancing_status_value_sensor_, this->system_status_value_sensor_,
+			this->configuration_status_value_sensor_, this->protection_status_value_1_sensor_, this->protection_status_value_2_sensor_, this->fault_status_value_sensor_,
+			this->status1_value_sensor_, this->status2_value_sensor_, this->status3_value_sensor_, this->status4_value_sensor_, this->status5_value_sensor_,
+			this->warning1_status_value_sensor_, this->warning2_status_value_sensor_, this->warning3_status_value_sensor_, this->warning4_status_value_sensor_,
+			this->warning5_status_value_sensor_, this->warning6_status_value_sensor_, this->power_status_value_sensor_, this->disconnection_status_value_sensor_,
+			this->warning7_status_value_sensor_, this->warning8_status_value_sensor_,
+			this->balance_event_value_sensor_, this->voltage_event_value_sensor_, this->temperature_event_value_sensor_, this->current_event_value_sensor_,
+			this->remaining_capacity_value_sensor_, this->fet_status_value_sensor_,
+		};
+		sensors.insert(sensors.end(), std::begin(this->warning_status_value_cells_sensor_), std::end(this->warning_status_value_cells_sensor_));
+		sensors.insert(sensors.end(), std::begin(this->warning_status_value_temps_sensor_), std::end(this->warning_status_value_temps_sensor_));
+	}
+	for (sensor::Sensor* sens : sensors) {
+		if (sens != nullptr)
+			this->parent_->queue_sensor_update([sens]() { sens->publish_state(NAN); });
+	}
+}
+
+// the same values as in analog information, from the smaller remaining capacity response read in between full analog reads
+void PaceBmsSensor::remaining_capacity_callback_v25(PaceBmsProtocolV25::RemainingCapacity& remaining_capacity) {
+	if (this->remaining_capacity_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = remaining_capacity.remainingCapacityMilliampHours]() { this->remaining_capacity_sensor_->publish_state(value * 0.001f); });
+	}
+	if (this->full_capacity_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = remaining_capacity.fullCapacityMilliampHours]() { this->full_capacity_sensor_->publish_state(value * 0.001f); });
+	}
+	if (this->design_capacity_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = remaining_capacity.designCapacityMilliampHours]() { this->design_capacity_sensor_->publish_state(value * 0.001f); });
+	}
+	if (this->state_of_charge_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = remaining_capacity.SoCHundredthsPercent]() { this->state_of_charge_sensor_->publish_state(value * 0.01f); });
+	}
+	if (this->state_of_health_sensor_ != nullptr) {
+		this->parent_->queue_sensor_update([this, value = remaining_capacity.SoHHundredthsPercent]() { this->state_of_health_sensor_->publish_state(value * 0.01f); });
 	}
 }
 
@@ -184,7 +356,7 @@ void PaceBmsSensor::analog_information_callback_v20(PaceBmsProtocolV20::AnalogIn
 	}
 	for (int i = 0; i < 16; i++) {
 		if (this->cell_voltage_sensor_[i] != nullptr) {
-			this->parent_->queue_sensor_update([this, i, value = analog_information.cellVoltagesMillivolts[i] / 1000.0f]() { this->cell_voltage_sensor_[i]->publish_state(value); });
+			this->parent_->queue_sensor_update([this, i, value = analog_information.cellVoltagesMillivolts[i]]() { this->cell_voltage_sensor_[i]->publish_state(value * 0.001f); });
 		}
 	}
 	if (this->temperature_count_sensor_ != nullptr) {
@@ -192,47 +364,54 @@ void PaceBmsSensor::analog_information_callback_v20(PaceBmsProtocolV20::AnalogIn
 	}
 	for (int i = 0; i < 6; i++) {
 		if (this->temperature_sensor_[i] != nullptr) {
-			this->parent_->queue_sensor_update([this, i, value = analog_information.temperaturesTenthsCelcius[i] / 10.0f]() { this->temperature_sensor_[i]->publish_state(value); });
+			this->parent_->queue_sensor_update([this, i, value = analog_information.temperaturesTenthsCelcius[i]]() { this->temperature_sensor_[i]->publish_state(value * 0.1f); });
 		}
 	}
 	if (this->current_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.currentMilliamps / 1000.0f]() { this->current_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.currentMilliamps]() { this->current_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->total_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.totalVoltageMillivolts / 1000.0f]() { this->total_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.totalVoltageMillivolts]() { this->total_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->remaining_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.remainingCapacityMilliampHours / 1000.0f]() { this->remaining_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.remainingCapacityMilliampHours]() { this->remaining_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->full_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.fullCapacityMilliampHours / 1000.0f]() { this->full_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.fullCapacityMilliampHours]() { this->full_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->design_capacity_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.designCapacityMilliampHours / 1000.0f]() { this->design_capacity_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.designCapacityMilliampHours]() { this->design_capacity_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->cycle_count_sensor_ != nullptr) {
 		this->parent_->queue_sensor_update([this, value = analog_information.cycleCount]() { this->cycle_count_sensor_->publish_state(value); });
 	}
 	if (this->state_of_charge_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.SoC]() { this->state_of_charge_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.SoCHundredthsPercent]() { this->state_of_charge_sensor_->publish_state(value * 0.01f); });
 	}
 	if (this->state_of_health_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.SoH]() { this->state_of_health_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.SoHHundredthsPercent]() { this->state_of_health_sensor_->publish_state(value * 0.01f); });
 	}
 	if (this->power_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.powerWatts]() { this->power_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.powerMilliwatts]() { this->power_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->min_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.minCellVoltageMillivolts / 1000.0f]() { this->min_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.minCellVoltageMillivolts]() { this->min_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->max_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.maxCellVoltageMillivolts / 1000.0f]() { this->max_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.maxCellVoltageMillivolts]() { this->max_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->avg_cell_voltage_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.avgCellVoltageMillivolts / 1000.0f]() { this->avg_cell_voltage_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.avgCellVoltageMillivolts]() { this->avg_cell_voltage_sensor_->publish_state(value * 0.001f); });
 	}
 	if (this->max_cell_differential_sensor_ != nullptr) {
-		this->parent_->queue_sensor_update([this, value = analog_information.maxCellDifferentialMillivolts / 1000.0f]() { this->max_cell_differential_sensor_->publish_state(value); });
+		this->parent_->queue_sensor_update([this, value = analog_information.maxCellDifferentialMillivolts]() { this->max_cell_differential_sensor_->publish_state(value * 0.001f); });
+	}
+	if (!this->statistics_.empty() || this->energy_ != nullptr) {
+		uint32_t now = millis();
+		for (auto* statistics : this->statistics_)
+			statistics->add_analog_information(this->parent_, analog_information, now);
+		if (this->energy_ != nullptr)
+			this->energy_->add_analog_information(this->parent_, analog_information, now);
 	}
 }
 
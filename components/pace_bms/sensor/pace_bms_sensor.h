@@ -5,6 +5,9 @@
 
 #include "esphome/components/pace_bms/pace_bms_component.h"
 
+#include "pace_bms_sensor_statistics.h"
+#include "pace_bms_sensor_energy.h"
+
 namespace esphome {
 namespace pace_bms {
 
@@ -70,9 +73,31 @@ public:
 	void set_remaining_capacity_value_sensor(sensor::Sensor* sens) { remaining_capacity_value_sensor_ = sens;                     request_status_info_callback_ = true; }
 	void set_fet_status_value_sensor(sensor::Sensor* sens)         { fet_status_value_sensor_ = sens;                     request_status_info_callback_ = true; }
 
+	// bus scheduler diagnostics
+	void set_missed_deadlines_sensor(sensor::Sensor* sens) { missed_deadlines_sensor_ = sens; }
+	void set_protection_missed_deadlines_sensor(sensor::Sensor* sens) { protection_missed_deadlines_sensor_ = sens; }
+	void set_bus_utilisation_sensor(sensor::Sensor* sens) { bus_utilisation_sensor_ = sens; }
+	void set_node_bus_utilisation_sensor(sensor::Sensor* sens) { node_bus_utilisation_sensor_ = sens; }
+	void set_response_timeouts_sensor(sensor::Sensor* sens) { response_timeouts_sensor_ = sens; }
+	void set_corrupt_responses_sensor(sensor::Sensor* sens) { corrupt_responses_sensor_ = sens; }
+	void set_request_retries_sensor(sensor::Sensor* sens) { request_retries_sensor_ = sens; }
+	void set_failed_requests_sensor(sensor::Sensor* sens) { failed_requests_sensor_ = sens; }
+
+	// how long ago each data group was last received
+	void set_analog_information_age_sensor(sensor::Sensor* sens) { analog_information_age_sensor_ = sens; }
+	void set_status_information_age_sensor(sensor::Sensor* sens) { status_information_age_sensor_ = sens; }
+	void set_configuration_age_sensor(sensor::Sensor* sens) { configuration_age_sensor_ = sens; }
+
+	// windowed statistics
+	void add_statistics(PaceBmsSensorStatistics* statistics) { statistics_.push_back(statistics);                    request_analog_info_callback_ = true; }
+
+	// energy / coulomb counter
+	void set_energy(PaceBmsSensorEnergy* energy) { energy_ = energy;                                                 request_analog_info_callback_ = true; }
+
 	void setup() override;
 	float get_setup_priority() const override { return setup_priority::DATA; };
 	void dump_config() override;
+	void on_shutdown() override;
 
 protected:
 	pace_bms::PaceBms* parent_;
@@ -135,14 +160,39 @@ protected:
 	sensor::Sensor* remaining_capacity_value_sensor_{ nullptr };
 	sensor::Sensor* fet_status_value_sensor_{ nullptr };
 
+	sensor::Sensor* missed_deadlines_sensor_{ nullptr };
+	sensor::Sensor* protection_missed_deadlines_sensor_{ nullptr };
+	sensor::Sensor* bus_utilisation_sensor_{ nullptr };
+	sensor::Sensor* node_bus_utilisation_sensor_{ nullptr };
+	sensor::Sensor* response_timeouts_sensor_{ nullptr };
+	sensor::Sensor* corrupt_responses_sensor_{ nullptr };
+	sensor::Sensor* request_retries_sensor_{ nullptr };
+	sensor::Sensor* failed_requests_sensor_{ nullptr };
+	// busy times as of the previous update, utilisation is published for the interval in between
+	uint64_t last_busy_time_{ 0 };
+	uint64_t last_node_busy_time_{ 0 };
+	uint32_t last_utilisation_time_{ 0 };
+
+	sensor::Sensor* analog_information_age_sensor_{ nullptr };
+	sensor::Sensor* status_information_age_sensor_{ nullptr };
+	sensor::Sensor* configuration_age_sensor_{ nullptr };
+
+	std::vector<PaceBmsSensorStatistics*> statistics_;
+	PaceBmsSensorEnergy* energy_{ nullptr };
+
 	bool request_analog_info_callback_ = false;
 	bool request_status_info_callback_ = false;
 
 	void analog_information_callback_v25(PaceBmsProtocolV25::AnalogInformation& analog_information);
 	void status_information_callback_v25(PaceBmsProtocolV25::StatusInformation& status_information);
+	void remaining_capacity_callback_v25(PaceBmsProtocolV25::RemainingCapacity& remaining_capacity);
 
 	void analog_information_callback_v20(PaceBmsProtocolV20::AnalogInformation& analog_information);
 	void status_information_callback_v20(PaceBmsProtocolV20::StatusInformation& status_information);
+
+	void scheduler_callback(const PaceBmsScheduler& scheduler);
+	void data_age_callback(PaceBms::DataGroup group, uint32_t age);
+	void stale_callback(PaceBms::DataGroup group);
 };
 
 }  // namespace pace_bms
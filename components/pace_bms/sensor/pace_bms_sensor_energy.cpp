@@ -0,0 +1,93 @@
+#include "esphome/core/log.h"
+
+#include "pace_bms_sensor_energy.h"
+
+namespace esphome {
+namespace pace_bms {
+
+static const char* const TAG = "pace_bms.sensor_energy";
+
+// 1 Ah == 1000 mA * 3600000 ms, same ratio for Wh
+static const float UNITS_PER_HOUR = 3600000000.0f;
+
+void PaceBmsSensorEnergy::setup() {
+	// key the saved totals off a configured sensor so that multiple packs each get their own slot
+	sensor::Sensor* key_sensor = this->charged_energy_sensor_;
+	if (key_sensor == nullptr)
+		key_sensor = this->discharged_energy_sensor_;
+	if (key_sensor == nullptr)
+		key_sensor = this->charged_capacity_sensor_;
+	if (key_sensor == nullptr)
+		key_sensor = this->discharged_capacity_sensor_;
+	if (key_sensor == nullptr)
+		return;
+
+	this->preference_ = global_preferences->make_preference<Totals>(key_sensor->get_object_id_hash() ^ 0x50414345UL, true);
+	if (this->preference_.load(&this->totals_)) {
+		ESP_LOGD(TAG, "Restored energy totals from flash");
+	}
+	else {
+		ESP_LOGD(TAG, "No saved energy totals, starting from zero");
+		this->totals_ = Totals();
+	}
+}
+
+void PaceBmsSensorEnergy::dump_config() {
+	ESP_LOGCONFIG(TAG, "  Energy save interval %u ms, max gap %u ms", (unsigned) this->save_interval_, (unsigned) this->max_gap_);
+	LOG_SENSOR("    ", "Charged Capacity", this->charged_capacity_sensor_);
+	LOG_SENSOR("    ", "Discharged Capacity", this->discharged_capacity_sensor_);
+	LOG_SENSOR("    ", "Charged Energy", this->charged_energy_sensor_);
+	LOG_SENSOR("    ", "Discharged Energy", this->discharged_energy_sensor_);
+}
+
+void PaceBmsSensorEnergy::add_sample_(PaceBms* parent, int32_t current_milliamps, int32_t milliwatts, uint32_t now) {
+	if (this->have_previous_) {
+		uint32_t dt = now - this->previous_time_;
+		if (dt > this->max_gap_) {
+			// we have no idea what happened while the BMS wasn't answering, don't make something up
+			ESP_LOGW(TAG, "Skipping energy integration over a %u ms gap between samples", (unsigned) dt);
+		}
+		else {
+			integrate_split_at_zero(this->previous_milliamps_, current_milliamps, dt, this->totals_.charged_milliamp_milliseconds, this->totals_.discharged_milliamp_milliseconds);
+			integrate_split_at_zero(this->previous_milliwatts_, milliwatts, dt, this->totals_.charged_milliwatt_milliseconds, this->totals_.discharged_milliwatt_milliseconds);
+			this->dirty_ = true;
+		}
+	}
+
+	this->have_previous_ = true;
+	this->previous_milliamps_ = current_milliamps;
+	this->previous_milliwatts_ = milliwatts;
+	this->previous_time_ = now;
+
+	this->publish_(parent);
+}
+
+void PaceBmsSensorEnergy::publish_(PaceBms* parent) {
+	if (this->charged_capacity_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->totals_.charged_milliamp_milliseconds / UNITS_PER_HOUR]() { this->charged_capacity_sensor_->publish_state(value); });
+	}
+	if (this->discharged_capacity_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->totals_.discharged_milliamp_milliseconds / UNITS_PER_HOUR]() { this->discharged_capacity_sensor_->publish_state(value); });
+	}
+	if (this->charged_energy_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->totals_.charged_milliwatt_milliseconds / UNITS_PER_HOUR]() { this->charged_energy_sensor_->publish_state(value); });
+	}
+	if (this->discharged_energy_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->totals_.discharged_milliwatt_milliseconds / UNITS_PER_HOUR]() { this->discharged_energy_sensor_->publish_state(value); });
+	}
+}
+
+void PaceBmsSensorEnergy::save() {
+	if (!this->dirty_)
+		return;
+	if (this->preference_.save(&this->totals_)) {
+		ESP_LOGV(TAG, "Saved energy totals");
+		this->dirty_ = false;
+	}
+	else {
+		ESP_LOGW(TAG, "Unable to save energy totals");
+	}
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
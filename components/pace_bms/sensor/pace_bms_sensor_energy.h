@@ -0,0 +1,80 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
+#include "esphome/components/sensor/sensor.h"
+
+#include "esphome/components/pace_bms/pace_bms_component.h"
+#include "pace_bms_energy_integration.h"
+
+namespace esphome {
+namespace pace_bms {
+
+/*
+* Coulomb / energy counter integrated on-device from the current and power in each analog information update.
+*
+* The BMS only gives us an instantaneous current and a remaining capacity with 10mAh resolution, so instead we integrate
+* current and power between polls.  Each poll-to-poll interval is integrated with the trapezoid rule, which is the same as
+* linearly interpolating the current between the two samples.  If the current changes sign within the interval, the
+* interpolated zero crossing is used to split it between the charge and discharge counters.
+*
+* Totals are kept as 64-bit integers so nothing is lost to float rounding over months of operation, and are saved to
+* flash periodically (not every poll) to keep wear down.  The flash layer itself (NVS on ESP32, the rotating sector
+* on ESP8266/RP2040) takes care of the rest of the wear levelling.
+*/
+class PaceBmsSensorEnergy {
+public:
+	void set_save_interval(uint32_t save_interval) { this->save_interval_ = save_interval; }
+	void set_max_gap(uint32_t max_gap) { this->max_gap_ = max_gap; }
+
+	void set_charged_capacity_sensor(sensor::Sensor* sens) { this->charged_capacity_sensor_ = sens; }
+	void set_discharged_capacity_sensor(sensor::Sensor* sens) { this->discharged_capacity_sensor_ = sens; }
+	void set_charged_energy_sensor(sensor::Sensor* sens) { this->charged_energy_sensor_ = sens; }
+	void set_discharged_energy_sensor(sensor::Sensor* sens) { this->discharged_energy_sensor_ = sens; }
+
+	uint32_t get_save_interval() { return this->save_interval_; }
+
+	// restores previously persisted totals, call from the owning component's setup()
+	void setup();
+	void dump_config();
+	// the owning component calls this every save_interval_ and on shutdown, it's a no-op if nothing changed
+	void save();
+
+	// the analog information structs are laid out identically for both protocol versions
+	template <typename AnalogInformation>
+	void add_analog_information(PaceBms* parent, const AnalogInformation& analog_information, uint32_t now) {
+		this->add_sample_(parent, analog_information.currentMilliamps, analog_information.powerMilliwatts, now);
+	}
+
+protected:
+	uint32_t save_interval_{ 900000 };
+	uint32_t max_gap_{ 300000 };
+
+	sensor::Sensor* charged_capacity_sensor_{ nullptr };
+	sensor::Sensor* discharged_capacity_sensor_{ nullptr };
+	sensor::Sensor* charged_energy_sensor_{ nullptr };
+	sensor::Sensor* discharged_energy_sensor_{ nullptr };
+
+	// milliamp-milliseconds and milliwatt-milliseconds, 3.6e9 of either is one Ah or Wh
+	struct Totals
+	{
+		uint64_t charged_milliamp_milliseconds{ 0 };
+		uint64_t discharged_milliamp_milliseconds{ 0 };
+		uint64_t charged_milliwatt_milliseconds{ 0 };
+		uint64_t discharged_milliwatt_milliseconds{ 0 };
+	} totals_;
+
+	ESPPreferenceObject preference_;
+	bool dirty_{ false };
+
+	bool have_previous_{ false };
+	int32_t previous_milliamps_{ 0 };
+	int32_t previous_milliwatts_{ 0 };
+	uint32_t previous_time_{ 0 };
+
+	void add_sample_(PaceBms* parent, int32_t current_milliamps, int32_t milliwatts, uint32_t now);
+	void publish_(PaceBms* parent);
+};
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -0,0 +1,70 @@
+#include <cmath>
+
+#include "esphome/core/log.h"
+
+#include "pace_bms_sensor_statistics.h"
+
+namespace esphome {
+namespace pace_bms {
+
+static const char* const TAG = "pace_bms.sensor_statistics";
+
+void PaceBmsSensorStatistics::add_sample_(float value) {
+	if (this->count_ == 0) {
+		this->min_ = value;
+		this->max_ = value;
+	}
+	else {
+		if (value < this->min_)
+			this->min_ = value;
+		if (value > this->max_)
+			this->max_ = value;
+	}
+
+	// Welford's online algorithm, numerically stable without keeping a sum of squares around
+	this->count_++;
+	float delta = value - this->mean_;
+	this->mean_ += delta / this->count_;
+	this->m2_ += delta * (value - this->mean_);
+}
+
+void PaceBmsSensorStatistics::publish_and_reset_(PaceBms* parent, uint32_t now) {
+	float variance = this->count_ > 1 ? this->m2_ / (this->count_ - 1) : 0.0f;
+
+	ESP_LOGV(TAG, "Window closed after %u ms with %u samples: min %f max %f mean %f variance %f",
+		(unsigned) (now - this->window_start_), (unsigned) this->count_, this->min_, this->max_, this->mean_, variance);
+
+	if (this->min_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->min_]() { this->min_sensor_->publish_state(value); });
+	}
+	if (this->max_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->max_]() { this->max_sensor_->publish_state(value); });
+	}
+	if (this->mean_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = this->mean_]() { this->mean_sensor_->publish_state(value); });
+	}
+	if (this->variance_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = variance]() { this->variance_sensor_->publish_state(value); });
+	}
+	if (this->stddev_sensor_ != nullptr) {
+		parent->queue_sensor_update([this, value = std::sqrt(variance)]() { this->stddev_sensor_->publish_state(value); });
+	}
+
+	this->count_ = 0;
+	this->min_ = 0;
+	this->max_ = 0;
+	this->mean_ = 0;
+	this->m2_ = 0;
+}
+
+void PaceBmsSensorStatistics::dump_config() {
+	ESP_LOGCONFIG(TAG, "  Statistics source %u index %u window %u ms", (unsigned) this->source_, (unsigned) this->index_ + 1, (unsigned) this->window_);
+	LOG_SENSOR("    ", "Min", this->min_sensor_);
+	LOG_SENSOR("    ", "Max", this->max_sensor_);
+	LOG_SENSOR("    ", "Mean", this->mean_sensor_);
+	LOG_SENSOR("    ", "Variance", this->variance_sensor_);
+	LOG_SENSOR("    ", "Standard Deviation", this->stddev_sensor_);
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+
+#include "esphome/components/pace_bms/pace_bms_component.h"
+
+namespace esphome {
+namespace pace_bms {
+
+/*
+* Windowed statistics over one analog value (or all cell voltages pooled together).
+*
+* Samples are folded into a fixed-size running accumulator (Welford's algorithm) as they arrive, no samples are stored.
+* When the window closes, min/max/mean/variance/standard deviation are published once and the accumulator is reset.
+* This lets you poll the BMS quickly but only send the aggregate over the network once per window.
+*/
+class PaceBmsSensorStatistics {
+public:
+	enum Source : uint8_t
+	{
+		SOURCE_CELL_VOLTAGE,
+		SOURCE_ALL_CELL_VOLTAGES,
+		SOURCE_TEMPERATURE,
+		SOURCE_CURRENT,
+		SOURCE_TOTAL_VOLTAGE,
+		SOURCE_POWER,
+		SOURCE_MAX_CELL_DIFFERENTIAL,
+	};
+
+	void set_source(Source source) { this->source_ = source; }
+	void set_index(uint8_t index) { this->index_ = index; }
+	void set_window(uint32_t window) { this->window_ = window; }
+
+	void set_min_sensor(sensor::Sensor* sens) { this->min_sensor_ = sens; }
+	void set_max_sensor(sensor::Sensor* sens) { this->max_sensor_ = sens; }
+	void set_mean_sensor(sensor::Sensor* sens) { this->mean_sensor_ = sens; }
+	void set_variance_sensor(sensor::Sensor* sens) { this->variance_sensor_ = sens; }
+	void set_stddev_sensor(sensor::Sensor* sens) { this->stddev_sensor_ = sens; }
+
+	// the analog information structs are laid out identically for both protocol versions
+	template <typename AnalogInformation>
+	void add_analog_information(PaceBms* parent, const AnalogInformation& analog_information, uint32_t now);
+
+	void dump_config();
+
+protected:
+	Source source_{ SOURCE_ALL_CELL_VOLTAGES };
+	uint8_t index_{ 0 };
+	uint32_t window_{ 60000 };
+
+	sensor::Sensor* min_sensor_{ nullptr };
+	sensor::Sensor* max_sensor_{ nullptr };
+	sensor::Sensor* mean_sensor_{ nullptr };
+	sensor::Sensor* variance_sensor_{ nullptr };
+	sensor::Sensor* stddev_sensor_{ nullptr };
+
+	// running accumulator for the current window
+	uint32_t window_start_{ 0 };
+	uint32_t count_{ 0 };
+	float min_{ 0 };
+	float max_{ 0 };
+	float mean_{ 0 };
+	float m2_{ 0 };
+
+	void add_sample_(float value);
+	void publish_and_reset_(PaceBms* parent, uint32_t now);
+};
+
+template <typename AnalogInformation>
+void PaceBmsSensorStatistics::add_analog_information(PaceBms* parent, const AnalogInformation& analog_information, uint32_t now) {
+	// close out the previous window before this sample is counted so each window covers exactly window_ ms
+	if (this->count_ > 0 && now - this->window_start_ >= this->window_) {
+		this->publish_and_reset_(parent, now);
+	}
+	if (this->count_ == 0) {
+		this->window_start_ = now;
+	}
+
+	switch (this->source_) {
+	case SOURCE_CELL_VOLTAGE:
+		if (this->index_ < analog_information.cellCount)
+			this->add_sample_(analog_information.cellVoltagesMillivolts[this->index_] * 0.001f);
+		break;
+	case SOURCE_ALL_CELL_VOLTAGES:
+		for (int i = 0; i < analog_information.cellCount; i++)
+			this->add_sample_(analog_information.cellVoltagesMillivolts[i] * 0.001f);
+		break;
+	case SOURCE_TEMPERATURE:
+		if (this->index_ < analog_information.temperatureCount)
+			this->add_sample_(analog_information.temperaturesTenthsCelcius[this->index_] * 0.1f);
+		break;
+	case SOURCE_CURRENT:
+		this->add_sample_(analog_information.currentMilliamps * 0.001f);
+		break;
+	case SOURCE_TOTAL_VOLTAGE:
+		this->add_sample_(analog_information.totalVoltageMillivolts * 0.001f);
+		break;
+	case SOURCE_POWER:
+		this->add_sample_(analog_information.powerMilliwatts * 0.001f);
+		break;
+	case SOURCE_MAX_CELL_DIFFERENTIAL:
+		this->add_sample_(analog_information.maxCellDifferentialMillivolts * 0.001f);
+		break;
+	}
+}
+
+}  // namespace pace_bms
+}  // namespace esphome
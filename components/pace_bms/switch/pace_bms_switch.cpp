@@ -16,7 +16,12 @@ void PaceBmsSwitch::setup() {
 			this->charge_current_limiter_switch_ != nullptr ||
 			this->charge_mosfet_switch_ != nullptr ||
 			this->discharge_mosfet_switch_ != nullptr) {
+			this->parent_->register_stale_callback([this](PaceBms::DataGroup group) {
+				if (group == PaceBms::DATA_GROUP_STATUS_INFORMATION)
+					this->set_stale_(true);
+			});
 			this->parent_->register_status_information_callback_v25([this](PaceBmsProtocolV25::StatusInformation& status_information) {
+				this->set_stale_(false);
 				if (this->buzzer_alarm_switch_ != nullptr) {
 					bool state = (status_information.configuration_value & PaceBmsProtocolV25::CF_BuzzerAlarmEnabledBit);
 					ESP_LOGV(TAG, "'buzzer_switch': Publishing state due to update from the hardware: %s", ONOFF(state));
@@ -75,6 +80,18 @@ void PaceBmsSwitch::setup() {
 	}
 }
 
+// the states are published from the same status information response, so they all go stale and come back together
+void PaceBmsSwitch::set_stale_(bool stale) {
+	if (this->stale_ == stale)
+		return;
+	this->stale_ = stale;
+	for (PaceBmsSwitchImplementation* sw : { this->buzzer_alarm_switch_, this->led_alarm_switch_, this->charge_current_limiter_switch_,
+			this->charge_mosfet_switch_, this->discharge_mosfet_switch_ }) {
+		if (sw != nullptr)
+			this->parent_->queue_sensor_update([sw, stale]() { sw->set_stale(stale); });
+	}
+}
+
 void PaceBmsSwitch::dump_config() {
 	ESP_LOGCONFIG(TAG, "pace_bms_switch:");
 	LOG_SWITCH("  ", "Buzzer Alarm", this->buzzer_alarm_switch_);
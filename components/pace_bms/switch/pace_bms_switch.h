@@ -34,6 +34,10 @@ protected:
 	pace_bms::PaceBmsSwitchImplementation* charge_current_limiter_switch_{ nullptr };
 	pace_bms::PaceBmsSwitchImplementation* charge_mosfet_switch_{ nullptr };
 	pace_bms::PaceBmsSwitchImplementation* discharge_mosfet_switch_{ nullptr };
+
+	// as last queued, the switches themselves only catch up when the sensor update queue is drained
+	bool stale_{ false };
+	void set_stale_(bool stale);
 };
 
 }  // namespace pace_bms
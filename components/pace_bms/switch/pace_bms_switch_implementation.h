@@ -12,11 +12,18 @@ public:
 
 	void add_on_write_state_callback(std::function<void(bool)>&& callback) { this->write_state_callback_.add(std::move(callback)); }
 
+	// a switch has no unknown state to publish in place of one that's gone stale, so it keeps showing the last one and 
+	//     this is set instead, for lambdas to check before acting on it
+	bool is_stale() const { return this->stale_; }
+	void set_stale(bool stale) { this->stale_ = stale; }
+
 protected:
 	// the only purpose of this class is to simply fill in this pure virtual and call the parent container component on user initiated state change request
 	void write_state(bool state) override;
 
 	CallbackManager<void(bool)> write_state_callback_{};
+
+	bool stale_{ false };
 };
 
 }  // namespace pace_bms
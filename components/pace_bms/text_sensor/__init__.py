@@ -3,6 +3,7 @@ import esphome.config_validation as cv
 from esphome.components import text_sensor
 from esphome.const import (
     CONF_ID,
+    ENTITY_CATEGORY_DIAGNOSTIC,
 )
 from .. import pace_bms_ns, CONF_PACE_BMS_ID, PaceBms
 
@@ -22,6 +23,8 @@ CONF_FAULT_STATUS         = "fault_status"
 CONF_HARDWARE_VERSION     = "hardware_version"
 CONF_SERIAL_NUMBER        = "serial_number"
 
+CONF_ADDRESS_SCAN         = "address_scan"
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(PaceBmsTextSensor),
@@ -36,6 +39,10 @@ CONFIG_SCHEMA = cv.Schema(
 
         cv.Optional(CONF_HARDWARE_VERSION): text_sensor.text_sensor_schema(),
         cv.Optional(CONF_SERIAL_NUMBER): text_sensor.text_sensor_schema(),
+
+        cv.Optional(CONF_ADDRESS_SCAN): text_sensor.text_sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
     }
 )
 
@@ -77,3 +84,7 @@ async def to_code(config):
     if serial_number_config := config.get(CONF_SERIAL_NUMBER):
         sens = await text_sensor.new_text_sensor(serial_number_config)
         cg.add(var.set_serial_number_sensor(sens))
+
+    if address_scan_config := config.get(CONF_ADDRESS_SCAN):
+        sens = await text_sensor.new_text_sensor(address_scan_config)
+        cg.add(var.set_address_scan_sensor(sens))
@@ -10,6 +10,15 @@ namespace pace_bms {
 static const char* const TAG = "pace_bms.textsensor";
 
 void PaceBmsTextSensor::setup() {
+	if (this->warning_status_sensor_ != nullptr ||
+		this->balancing_status_sensor_ != nullptr ||
+		this->system_status_sensor_ != nullptr ||
+		this->configuration_status_sensor_ != nullptr ||
+		this->protection_status_sensor_ != nullptr ||
+		this->fault_status_sensor_ != nullptr) {
+		this->parent_->register_stale_callback([this](PaceBms::DataGroup group) { this->stale_callback(group); });
+	}
+
 	if (this->parent_->get_protocol_commandset() == 0x25) {
 		if (this->warning_status_sensor_ != nullptr ||
 			this->balancing_status_sensor_ != nullptr ||
@@ -99,6 +108,24 @@ void PaceBmsTextSensor::setup() {
 	else {
 		ESP_LOGE(TAG, "Protocol version not supported: 0x%02X", this->parent_->get_protocol_commandset());
 	}
+
+	if (this->address_scan_sensor_ != nullptr) {
+		this->parent_->register_address_scan_callback([this](std::string& result) {
+			this->parent_->queue_sensor_update([this, value = result]() { this->address_scan_sensor_->publish_state(value); });
+		});
+	}
+}
+
+// home assistant shows a state of "unknown" as unknown, the way a numeric sensor shows NAN, until the next good 
+//     status information response publishes the real text again
+void PaceBmsTextSensor::stale_callback(PaceBms::DataGroup group) {
+	if (group != PaceBms::DATA_GROUP_STATUS_INFORMATION)
+		return;
+	for (text_sensor::TextSensor* sens : { this->warning_status_sensor_, this->balancing_status_sensor_, this->system_status_sensor_,
+			this->configuration_status_sensor_, this->protection_status_sensor_, this->fault_status_sensor_ }) {
+		if (sens != nullptr)
+			this->parent_->queue_sensor_update([sens]() { sens->publish_state("unknown"); });
+	}
 }
 
 void PaceBmsTextSensor::dump_config() {
@@ -111,6 +138,7 @@ void PaceBmsTextSensor::dump_config() {
 	LOG_TEXT_SENSOR("  ", "Fault Status", this->fault_status_sensor_);
 	LOG_TEXT_SENSOR("  ", "Hardware Version", this->hardware_version_sensor_);
 	LOG_TEXT_SENSOR("  ", "Serial Number", this->serial_number_sensor_);
+	LOG_TEXT_SENSOR("  ", "Address Scan", this->address_scan_sensor_);
 }
 
 }  // namespace pace_bms
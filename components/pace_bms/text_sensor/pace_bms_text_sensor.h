@@ -20,6 +20,7 @@ public:
 
 	void set_hardware_version_sensor(text_sensor::TextSensor* hardware_version_sensor) { hardware_version_sensor_ = hardware_version_sensor; }
 	void set_serial_number_sensor(text_sensor::TextSensor* serial_number_sensor) { serial_number_sensor_ = serial_number_sensor; }
+	void set_address_scan_sensor(text_sensor::TextSensor* address_scan_sensor) { address_scan_sensor_ = address_scan_sensor; }
 
 	void setup() override;
 	float get_setup_priority() const override { return setup_priority::DATA; };
@@ -36,6 +37,11 @@ protected:
 
 	text_sensor::TextSensor* hardware_version_sensor_{ nullptr };
 	text_sensor::TextSensor* serial_number_sensor_{ nullptr };
+
+	// not tied to a protocol version
+	text_sensor::TextSensor* address_scan_sensor_{ nullptr };
+
+	void stale_callback(PaceBms::DataGroup group);
 };
 
 }  // namespace pace_bms
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Builds the protocol parser fuzzer, see fuzz_pace_bms.cpp for the input format.
+#
+#   fuzz/build.sh
+#   fuzz/out/fuzz_pace_bms -jobs=4 fuzz/out/corpus fuzz/out/seeds     (libFuzzer, needs clang)
+#   fuzz/out/fuzz_pace_bms_standalone --bench 10 fuzz/out/seeds/*      (throughput of the parsers alone)
+#   afl-fuzz -i fuzz/out/seeds -o fuzz/out/afl -- fuzz/out/fuzz_pace_bms_standalone @@   (build with CXX=afl-clang-fast++)
+#
+# Both binaries are built with AddressSanitizer and UndefinedBehaviorSanitizer.  _GLIBCXX_ASSERTIONS / libc++ hardening
+# turn an out of range std::vector operator[] into an abort, otherwise ASan can't see reads past size() but inside capacity.
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../components/pace_bms"
+OUT="${OUT:-$HERE/out}"
+
+SOURCES="$HERE/fuzz_pace_bms.cpp $SRC/pace_bms_protocol_base.cpp $SRC/pace_bms_protocol_v20.cpp $SRC/pace_bms_protocol_v25.cpp"
+FLAGS="-std=c++17 -g -O1 -fno-omit-frame-pointer -I$SRC -DPACE_BMS_USE_STD_OPTIONAL -D_GLIBCXX_ASSERTIONS -D_LIBCPP_HARDENING_MODE=_LIBCPP_HARDENING_MODE_DEBUG"
+SANITIZERS="address,undefined"
+
+mkdir -p "$OUT" "$OUT/seeds" "$OUT/corpus"
+
+# standalone driver: replays files, writes the seed corpus and measures throughput, works with any compiler
+${CXX:-c++} $FLAGS -fsanitize=$SANITIZERS -fno-sanitize-recover=all -DPACE_BMS_FUZZ_STANDALONE $SOURCES -o "$OUT/fuzz_pace_bms_standalone"
+"$OUT/fuzz_pace_bms_standalone" --write-seeds "$OUT/seeds"
+
+# libFuzzer reports exec/s itself in its status lines
+if command -v ${CLANGXX:-clang++} >/dev/null 2>&1; then
+	${CLANGXX:-clang++} $FLAGS -fsanitize=fuzzer,$SANITIZERS -fno-sanitize-recover=all $SOURCES -o "$OUT/fuzz_pace_bms"
+else
+	echo "clang++ not found, skipping the libFuzzer build"
+fi
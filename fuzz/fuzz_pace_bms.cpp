@@ -0,0 +1,359 @@
+/*
+* Fuzzer for every PaceBmsProtocolV25::Process* and PaceBmsProtocolV20::Process* response parser.
+*
+* Builds as a libFuzzer target (clang -fsanitize=fuzzer) or, with PACE_BMS_FUZZ_STANDALONE defined, as a plain executable
+* that replays files, writes the seed corpus from the example frames, and measures throughput.  The standalone build also
+* works as an AFL++ target (afl-clang-fast++, then run it with @@).  See build.sh.
+*
+* Input layout:
+*   byte 0:     which parser to call (modulo the number of targets below)
+*   byte 1:     bit 0     - 0: the rest of the input is the raw response frame
+*                           1: the rest of the input is just the payload, wrap it in a valid header/length/checksum/EOI so
+*                              the fuzzer doesn't have to guess checksums to get past ValidateResponseAndGetPayloadLength
+*               bits 1..2 - V20 protocol variant: auto-detect, PYLON, SEPLOS, EG4
+*               bits 3..4 - battery chemistry (CID1), index into the list for that protocol version
+*               bits 5..7 - bus id
+*   byte 2...:  frame or payload
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pace_bms_protocol_v20.h"
+#include "pace_bms_protocol_v25.h"
+
+namespace {
+
+// the messages are thrown away, but still formatted so a bad format string or argument shows up under the sanitizers
+void LogDiscard(PaceBmsProtocolBase::LogLevel, const char* format, va_list args)
+{
+	char message[256];
+	vsnprintf(message, sizeof(message), format, args);
+}
+
+// the frame checksum and length helpers are protected, this just makes them reachable
+class FrameHelper : public PaceBmsProtocolBase
+{
+public:
+	using PaceBmsProtocolBase::CreateChecksummedLength;
+	using PaceBmsProtocolBase::CalculateRequestOrResponseChecksum;
+};
+
+const uint8_t chemistriesV25[] = { PaceBmsProtocolV25::CID1_LithiumIron, PaceBmsProtocolV25::CID1_LithiumIon };
+const uint8_t chemistriesV20[] = { PaceBmsProtocolV20::CID1_LithiumIron, PaceBmsProtocolV20::CID1_LithiumIron_EG4, PaceBmsProtocolV20::CID1_LithiumTitanate_Manganese_EG4, PaceBmsProtocolV20::CID1_LithiumTitanate_Ternary_EG4 };
+const char* const variantsV20[] = { nullptr, "PYLON", "SEPLOS", "EG4" };
+
+struct Options
+{
+	bool fixup;
+	uint8_t variant;
+	uint8_t chemistry;
+	uint8_t busId;
+};
+
+Options DecodeOptions(uint8_t flags)
+{
+	Options options;
+	options.fixup = (flags & 0x01) != 0;
+	options.variant = (flags >> 1) & 0x03;
+	options.chemistry = (flags >> 3) & 0x03;
+	options.busId = (flags >> 5) & 0x07;
+	return options;
+}
+
+uint8_t EncodeOptions(const Options& options)
+{
+	return (options.fixup ? 0x01 : 0x00) | (options.variant << 1) | (options.chemistry << 3) | (options.busId << 5);
+}
+
+typedef bool (*RunV25)(PaceBmsProtocolV25& protocol, uint8_t busId, const std::vector<uint8_t>& response);
+typedef bool (*RunV20)(PaceBmsProtocolV20& protocol, uint8_t busId, const std::vector<uint8_t>& response);
+
+struct Target
+{
+	const char* name;
+	uint8_t version;
+	RunV25 runV25;
+	RunV20 runV20;
+	// used to build the seed corpus, may be empty
+	const uint8_t* example;
+};
+
+template <typename Configuration>
+bool ReadConfigurationV25(PaceBmsProtocolV25& protocol, uint8_t busId, const std::vector<uint8_t>& response)
+{
+	Configuration config;
+	return protocol.ProcessReadConfigurationResponse(busId, response, config);
+}
+
+const Target targets[] = {
+	{ "v25_analog", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV25::AnalogInformation a; return p.ProcessReadAnalogInformationResponse(b, r, a); }, nullptr, PaceBmsProtocolV25::exampleReadAnalogInformationResponseV25 },
+	{ "v25_status", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV25::StatusInformation s; return p.ProcessReadStatusInformationResponse(b, r, s); }, nullptr, PaceBmsProtocolV25::exampleReadStatusInformationResponseV25 },
+	{ "v25_hardware_version", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { std::string s; return p.ProcessReadHardwareVersionResponse(b, r, s); }, nullptr, PaceBmsProtocolV25::exampleReadHardwareVersionResponseV25 },
+	{ "v25_serial_number", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { std::string s; return p.ProcessReadSerialNumberResponse(b, r, s); }, nullptr, PaceBmsProtocolV25::exampleReadSerialNumberResponseV25 },
+	{ "v25_switch_command", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteSwitchCommandResponse(b, PaceBmsProtocolV25::SC_EnableBuzzer, r); }, nullptr, PaceBmsProtocolV25::exampleWriteEnableBuzzerSwitchCommandResponseV25 },
+	{ "v25_mosfet_switch_command", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteMosfetSwitchCommandResponse(b, PaceBmsProtocolV25::MT_Charge, PaceBmsProtocolV25::MS_Open, r); }, nullptr, PaceBmsProtocolV25::exampleWriteMosfetChargeOpenSwitchCommandResponseV25 },
+	{ "v25_shutdown", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteShutdownCommandResponse(b, r); }, nullptr, PaceBmsProtocolV25::exampleWriteRebootCommandResponseV25 },
+	{ "v25_read_date_time", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV25::DateTime d; return p.ProcessReadSystemDateTimeResponse(b, r, d); }, nullptr, PaceBmsProtocolV25::exampleReadSystemTimeResponseV25 },
+	{ "v25_write_date_time", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteSystemDateTimeResponse(b, r); }, nullptr, PaceBmsProtocolV25::exampleWriteSystemTimeResponseV25 },
+	{ "v25_write_configuration", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteConfigurationResponse(b, r); }, nullptr, PaceBmsProtocolV25::exampleWriteCellOverVoltageConfigurationResponseV25 },
+	{ "v25_cell_over_voltage", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::CellOverVoltageConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadCellOverVoltageConfigurationResponseV25 },
+	{ "v25_pack_over_voltage", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::PackOverVoltageConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadPackOverVoltageConfigurationResponseV25 },
+	{ "v25_cell_under_voltage", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::CellUnderVoltageConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadCellUnderVoltageConfigurationResponseV25 },
+	{ "v25_pack_under_voltage", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::PackUnderVoltageConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadPackUnderVoltageConfigurationResponseV25 },
+	{ "v25_charge_over_current", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::ChargeOverCurrentConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadChargeOverCurrentConfigurationResponseV25 },
+	{ "v25_discharge_over_current_1", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::DischargeOverCurrent1Configuration>, nullptr, PaceBmsProtocolV25::exampleReadDishargeOverCurrent1ConfigurationResponseV25 },
+	{ "v25_discharge_over_current_2", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::DischargeOverCurrent2Configuration>, nullptr, PaceBmsProtocolV25::exampleReadDishargeOverCurrent2ConfigurationResponseV25 },
+	{ "v25_short_circuit_protection", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::ShortCircuitProtectionConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadShortCircuitProtectionConfigurationResponseV25 },
+	{ "v25_cell_balancing", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::CellBalancingConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadCellBalancingConfigurationResponseV25 },
+	{ "v25_sleep", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::SleepConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadSleepConfigurationResponseV25 },
+	{ "v25_full_charge_low_charge", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::FullChargeLowChargeConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadFullChargeLowChargeConfigurationResponseV25 },
+	{ "v25_charge_discharge_over_temperature", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::ChargeAndDischargeOverTemperatureConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadChargeAndDischargeOverTemperatureConfigurationResponseV25 },
+	{ "v25_charge_discharge_under_temperature", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::ChargeAndDischargeUnderTemperatureConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadChargeAndDischargeUnderTemperatureConfigurationResponseV25 },
+	{ "v25_mosfet_over_temperature", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::MosfetOverTemperatureConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadMosfetOverTemperatureConfigurationResponseV25 },
+	{ "v25_environment_over_under_temperature", 0x25, ReadConfigurationV25<PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration>, nullptr, PaceBmsProtocolV25::exampleReadEnvironmentOverUnderTemperatureConfigurationResponseV25 },
+	{ "v25_read_charge_current_limiter_start_current", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { uint8_t c; return p.ProcessReadChargeCurrentLimiterStartCurrentResponse(b, r, c); }, nullptr, PaceBmsProtocolV25::exampleReadChargeCurrentLimiterStartCurrentResponseV25 },
+	{ "v25_write_charge_current_limiter_start_current", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteChargeCurrentLimiterStartCurrentResponse(b, r); }, nullptr, PaceBmsProtocolV25::exampleWriteChargeCurrentLimiterStartCurrentResponseV25 },
+	{ "v25_remaining_capacity", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { uint32_t remaining, actual, design; return p.ProcessReadRemainingCapacityResponse(b, r, remaining, actual, design); }, nullptr, PaceBmsProtocolV25::exampleReadRemainingCapacityResponseV25 },
+	{ "v25_read_protocols", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV25::Protocols protocols; return p.ProcessReadProtocolsResponse(b, r, protocols); }, nullptr, PaceBmsProtocolV25::exampleReadProtocolsResponseV25 },
+	{ "v25_write_protocols", 0x25, [](PaceBmsProtocolV25& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteProtocolsResponse(b, r); }, nullptr, PaceBmsProtocolV25::exampleWriteProtocolsResponseV25 },
+
+	{ "v20_analog", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV20::AnalogInformation a; return p.ProcessReadAnalogInformationResponse(b, r, a); }, PaceBmsProtocolV20::exampleReadAnalogInformationResponseV20 },
+	{ "v20_status", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV20::StatusInformation s; return p.ProcessReadStatusInformationResponse(b, r, s); }, PaceBmsProtocolV20::exampleReadStatusInformationResponseV20 },
+	{ "v20_hardware_version", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { std::string s; return p.ProcessReadHardwareVersionResponse(b, r, s); }, PaceBmsProtocolV20::exampleReadHardwareVersionResponseV20 },
+	{ "v20_serial_number", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { std::string s; return p.ProcessReadSerialNumberResponse(b, r, s); }, PaceBmsProtocolV20::exampleReadSerialNumberResponseV20 },
+	{ "v20_shutdown", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteShutdownCommandResponse(b, r); }, PaceBmsProtocolV20::exampleWriteRebootCommandResponseV20 },
+	{ "v20_read_date_time", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { PaceBmsProtocolV20::DateTime d; return p.ProcessReadSystemDateTimeResponse(b, r, d); }, PaceBmsProtocolV20::exampleReadSystemTimeResponseV20 },
+	{ "v20_write_date_time", 0x20, nullptr, [](PaceBmsProtocolV20& p, uint8_t b, const std::vector<uint8_t>& r) { return p.ProcessWriteSystemDateTimeResponse(b, r); }, PaceBmsProtocolV20::exampleWriteSystemTimeResponseV20 },
+};
+const size_t targetCount = sizeof(targets) / sizeof(targets[0]);
+
+const char hexDigits[] = "0123456789ABCDEF";
+
+void AppendHexByte(std::vector<uint8_t>& frame, uint8_t byte)
+{
+	frame.push_back(hexDigits[byte >> 4]);
+	frame.push_back(hexDigits[byte & 0x0F]);
+}
+
+// wrap a fuzzed payload in a frame that passes header, length and checksum validation
+void BuildFrame(uint8_t version, uint8_t busId, uint8_t cid1, const uint8_t* payload, size_t payloadLen, std::vector<uint8_t>& frame)
+{
+	// the length field is only 12 bits
+	if (payloadLen > 0x0FFF)
+		payloadLen = 0x0FFF;
+
+	frame.clear();
+	frame.reserve(payloadLen + 18);
+	frame.push_back('~');
+	AppendHexByte(frame, version);
+	AppendHexByte(frame, busId);
+	AppendHexByte(frame, cid1);
+	AppendHexByte(frame, 0x00);
+	uint16_t cklen = FrameHelper::CreateChecksummedLength((uint16_t)payloadLen);
+	AppendHexByte(frame, cklen >> 8);
+	AppendHexByte(frame, cklen & 0xFF);
+	// keep the payload mostly valid hex, otherwise nearly every field decodes as garbage and the interesting branches are never reached
+	for (size_t i = 0; i < payloadLen; i++)
+		frame.push_back((payload[i] & 0x80) ? payload[i] : hexDigits[payload[i] & 0x0F]);
+	frame.insert(frame.end(), { '0', '0', '0', '0', '\r' });
+	uint16_t checksum = FrameHelper::CalculateRequestOrResponseChecksum(frame);
+	frame[frame.size() - 5] = hexDigits[(checksum >> 12) & 0x0F];
+	frame[frame.size() - 4] = hexDigits[(checksum >> 8) & 0x0F];
+	frame[frame.size() - 3] = hexDigits[(checksum >> 4) & 0x0F];
+	frame[frame.size() - 2] = hexDigits[checksum & 0x0F];
+}
+
+void RunOne(const uint8_t* data, size_t size)
+{
+	if (size < 2)
+		return;
+
+	const Target& target = targets[data[0] % targetCount];
+	Options options = DecodeOptions(data[1]);
+	data += 2;
+	size -= 2;
+
+	uint8_t cid1;
+	if (target.version == 0x25)
+		cid1 = chemistriesV25[options.chemistry % sizeof(chemistriesV25)];
+	else
+		cid1 = chemistriesV20[options.chemistry % sizeof(chemistriesV20)];
+
+	std::vector<uint8_t> response;
+	if (options.fixup)
+		BuildFrame(target.version, options.busId, cid1, data, size, response);
+	else
+		response.assign(data, data + size);
+
+	// fresh instance every time, the V20 parser remembers the detected variant between calls
+	if (target.version == 0x25)
+	{
+		PaceBmsProtocolV25 protocol({}, {}, cid1, LogDiscard);
+		target.runV25(protocol, options.busId, response);
+	}
+	else
+	{
+		OPTIONAL_NS::optional<std::string> variant;
+		if (variantsV20[options.variant] != nullptr)
+			variant = std::string(variantsV20[options.variant]);
+		PaceBmsProtocolV20 protocol(variant, {}, cid1, LogDiscard);
+		target.runV20(protocol, options.busId, response);
+	}
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	RunOne(data, size);
+	return 0;
+}
+
+#ifdef PACE_BMS_FUZZ_STANDALONE
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+bool ReadFile(const char* path, std::vector<uint8_t>& contents)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& contents)
+{
+	std::ofstream file(path, std::ios::binary);
+	file.write((const char*)contents.data(), contents.size());
+	return (bool)file;
+}
+
+// one seed per target in raw mode using the example frame as-is, plus one in fixup mode using just its payload
+int WriteSeeds(const std::string& directory)
+{
+	int written = 0;
+	for (size_t i = 0; i < targetCount; i++)
+	{
+		const Target& target = targets[i];
+		size_t len = strlen((const char*)target.example);
+		if (len < 18)
+			continue;
+
+		// take the bus id and chemistry from the example frame's ADR and CID1
+		Options options = { false, 0, 0, 0 };
+		options.busId = (uint8_t)std::stoi(std::string((const char*)target.example + 3, 2), nullptr, 16) & 0x07;
+		uint8_t cid1 = (uint8_t)std::stoi(std::string((const char*)target.example + 5, 2), nullptr, 16);
+		const uint8_t* chemistries = target.version == 0x25 ? chemistriesV25 : chemistriesV20;
+		size_t chemistryCount = target.version == 0x25 ? sizeof(chemistriesV25) : sizeof(chemistriesV20);
+		for (size_t c = 0; c < chemistryCount; c++)
+			if (chemistries[c] == cid1)
+				options.chemistry = (uint8_t)c;
+
+		std::vector<uint8_t> seed = { (uint8_t)i, EncodeOptions(options) };
+		seed.insert(seed.end(), target.example, target.example + len);
+		if (!WriteFile(directory + "/" + target.name + "_raw", seed))
+			return -1;
+
+		options.fixup = true;
+		seed = { (uint8_t)i, EncodeOptions(options) };
+		seed.insert(seed.end(), target.example + 13, target.example + len - 5);
+		if (!WriteFile(directory + "/" + target.name + "_payload", seed))
+			return -1;
+
+		written += 2;
+	}
+	printf("Wrote %d seeds to %s\n", written, directory.c_str());
+	return 0;
+}
+
+// replay the given inputs over and over for a while and report how fast the parsers go
+int Benchmark(double seconds, const std::vector<std::vector<uint8_t>>& inputs)
+{
+	if (inputs.empty())
+	{
+		fprintf(stderr, "No inputs to benchmark\n");
+		return 1;
+	}
+
+	std::vector<uint64_t> execs(targetCount, 0);
+	std::vector<double> elapsed(targetCount, 0);
+	auto start = std::chrono::steady_clock::now();
+	uint64_t total = 0;
+	double totalSeconds = 0;
+	while (totalSeconds < seconds)
+	{
+		for (const auto& input : inputs)
+		{
+			auto before = std::chrono::steady_clock::now();
+			RunOne(input.data(), input.size());
+			auto after = std::chrono::steady_clock::now();
+			if (input.size() >= 2)
+			{
+				size_t t = input[0] % targetCount;
+				execs[t]++;
+				elapsed[t] += std::chrono::duration<double>(after - before).count();
+			}
+			total++;
+		}
+		totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	for (size_t t = 0; t < targetCount; t++)
+		if (execs[t] > 0)
+			printf("%-48s %12.0f execs/sec\n", targets[t].name, execs[t] / elapsed[t]);
+	printf("%-48s %12.0f execs/sec (%llu execs in %.1f s)\n", "total", total / totalSeconds, (unsigned long long)total, totalSeconds);
+	return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc == 3 && strcmp(argv[1], "--write-seeds") == 0)
+		return WriteSeeds(argv[2]) == 0 ? 0 : 1;
+
+	double benchSeconds = 0;
+	int first = 1;
+	if (argc >= 3 && strcmp(argv[1], "--bench") == 0)
+	{
+		benchSeconds = atof(argv[2]);
+		first = 3;
+	}
+	if (first >= argc)
+	{
+		fprintf(stderr, "usage: %s --write-seeds DIR\n", argv[0]);
+		fprintf(stderr, "       %s [--bench SECONDS] FILE...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<std::vector<uint8_t>> inputs;
+	for (int i = first; i < argc; i++)
+	{
+		std::vector<uint8_t> contents;
+		if (!ReadFile(argv[i], contents))
+		{
+			fprintf(stderr, "Unable to read %s\n", argv[i]);
+			return 1;
+		}
+		if (benchSeconds > 0)
+			inputs.push_back(contents);
+		else
+			RunOne(contents.data(), contents.size());
+	}
+
+	if (benchSeconds > 0)
+		return Benchmark(benchSeconds, inputs);
+	printf("Ran %d inputs\n", argc - first);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Builds and runs the host-side checks of the parts of the component that have no esphome dependencies, see 
+# test_pace_bms.cpp.
+#
+#   test/build.sh
+#
+# Built with AddressSanitizer and UndefinedBehaviorSanitizer like the fuzzer.
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../components/pace_bms"
+OUT="${OUT:-$HERE/out}"
+
+mkdir -p "$OUT"
+${CXX:-c++} -std=c++17 -g -O1 -Wall -Wextra -I"$SRC" -I"$SRC/sensor" -DPACE_BMS_USE_STD_OPTIONAL \
+	-fsanitize=address,undefined -fno-sanitize-recover=all \
+	"$HERE/test_pace_bms.cpp" "$SRC/pace_bms_scheduler.cpp" "$SRC/pace_bms_proxy_cache.cpp" \
+	-o "$OUT/test_pace_bms"
+"$OUT/test_pace_bms"
@@ -0,0 +1,323 @@
+/*
+* Host-side checks for the parts of pace_bms that don't depend on esphome, run by build.sh.
+*
+* Each check prints what it compared when it fails, and the exit code is the number of failures.
+*/
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pace_bms_energy_integration.h"
+#include "pace_bms_proxy_cache.h"
+#include "pace_bms_scheduler.h"
+
+using namespace esphome::pace_bms;
+
+namespace {
+
+int failures = 0;
+
+void CheckEqual(const char* what, uint64_t actual, uint64_t expected)
+{
+	if (actual == expected)
+		return;
+	printf("FAIL %s: got %" PRIu64 ", expected %" PRIu64 "\n", what, actual, expected);
+	failures++;
+}
+
+void CheckText(const char* what, const std::string& actual, const char* expected)
+{
+	if (actual == expected)
+		return;
+	printf("FAIL %s: got %s, expected %s\n", what, actual.c_str(), expected);
+	failures++;
+}
+
+void CheckIntegration(const char* what, int32_t from, int32_t to, uint32_t dt, uint64_t expected_positive, uint64_t expected_negative)
+{
+	uint64_t positive = 0;
+	uint64_t negative = 0;
+	integrate_split_at_zero(from, to, dt, positive, negative);
+	printf("  %s\n", what);
+	CheckEqual("positive", positive, expected_positive);
+	CheckEqual("negative", negative, expected_negative);
+}
+
+// milliamps (or milliwatts) over milliseconds, 5 s at 50 A is 250000000
+void EnergyIntegrationTests()
+{
+	printf("energy integration\n");
+	CheckIntegration("constant charge", 50000, 50000, 5000, 250000000, 0);
+	CheckIntegration("constant discharge", -50000, -50000, 5000, 0, 250000000);
+	CheckIntegration("idle", 0, 0, 5000, 0, 0);
+	// a pack sitting at exactly 0 mA that starts discharging (or stops) is all discharge, none of it charge
+	CheckIntegration("zero to discharge", 0, -50000, 5000, 0, 125000000);
+	CheckIntegration("discharge to zero", -50000, 0, 5000, 0, 125000000);
+	CheckIntegration("zero to charge", 0, 50000, 5000, 125000000, 0);
+	CheckIntegration("charge to zero", 50000, 0, 5000, 125000000, 0);
+	// crossing at the midpoint, a triangle either side
+	CheckIntegration("charge to discharge", 50000, -50000, 5000, 62500000, 62500000);
+	CheckIntegration("discharge to charge", -50000, 50000, 5000, 62500000, 62500000);
+}
+
+PaceBmsScheduler::command_item* MakeCommand(const char* description)
+{
+	PaceBmsScheduler::command_item* item = new PaceBmsScheduler::command_item;
+	item->description_ = description;
+	return item;
+}
+
+// queue_read_ leans on contains() to not queue a second copy of a read, wherever in the scheduler the first one is
+void SchedulerContainsTests()
+{
+	printf("scheduler contains\n");
+	PaceBmsScheduler scheduler;
+	scheduler.push(MakeCommand("read analog information"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+	scheduler.push_next(MakeCommand("read cell over voltage configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0);
+	CheckEqual("queued", scheduler.contains("read analog information"), true);
+	CheckEqual("queued next", scheduler.contains("read cell over voltage configuration"), true);
+	CheckEqual("not queued", scheduler.contains("read status information"), false);
+
+	// once popped it's the owner's to account for
+	delete scheduler.pop(0);
+	CheckEqual("popped", scheduler.contains("read cell over voltage configuration"), false);
+	CheckEqual("still queued", scheduler.contains("read analog information"), true);
+}
+
+const uint8_t PROTECTION_ONLY = PaceBmsScheduler::priority_mask(PaceBmsScheduler::PRIORITY_PROTECTION);
+
+// the descriptions of the next count commands granted at now, in order, "none" where nothing is
+std::string PopOrder(PaceBmsScheduler& scheduler, uint32_t now, size_t count, uint8_t mask = PaceBmsScheduler::ALL_PRIORITIES)
+{
+	std::string order;
+	for (size_t i = 0; i < count; i++) {
+		PaceBmsScheduler::command_item* item = scheduler.pop(now, mask);
+		if (!order.empty())
+			order += ",";
+		order += item == nullptr ? std::string("none") : item->description_;
+		delete item;
+	}
+	return order;
+}
+
+void CheckPopOrder(const char* what, PaceBmsScheduler& scheduler, uint32_t now, size_t count, const char* expected, uint8_t mask = PaceBmsScheduler::ALL_PRIORITIES)
+{
+	printf("  %s\n", what);
+	CheckText(what, PopOrder(scheduler, now, count, mask), expected);
+}
+
+void SchedulerOrderTests()
+{
+	printf("scheduler order\n");
+	{
+		// all on time, earliest deadline first whatever the class
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+		scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 1000);
+		scheduler.push(MakeCommand("information"), PaceBmsScheduler::PRIORITY_INFORMATION, 0, 3000);
+		CheckPopOrder("earliest deadline first", scheduler, 0, 4, "configuration,information,protection,none");
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 1000);
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1000);
+		scheduler.push(MakeCommand("protection 2"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1000);
+		CheckPopOrder("same deadline, class then queued order", scheduler, 0, 3, "protection,protection 2,configuration");
+	}
+	{
+		// at 2000 both are late, but neither by a whole period
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 1500);
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1800);
+		CheckPopOrder("late, class first", scheduler, 2000, 2, "protection,configuration");
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+		scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 1500);
+		CheckPopOrder("late before on time", scheduler, 2000, 2, "configuration,protection");
+	}
+	{
+		// at 2000 the configuration read is more than its 500 ms period late
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1800);
+		scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 500);
+		CheckPopOrder("a whole period late beats class", scheduler, 2000, 2, "configuration,protection");
+	}
+	{
+		// deadlines compared wrap-safe across a millis() rollover
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("after"), PaceBmsScheduler::PRIORITY_PROTECTION, 0xFFFFF000, 0x2000);
+		scheduler.push(MakeCommand("before"), PaceBmsScheduler::PRIORITY_PROTECTION, 0xFFFFF000, 0x800);
+		CheckPopOrder("across rollover", scheduler, 0xFFFFF000, 2, "before,after");
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 0);
+		scheduler.push_next(MakeCommand("next"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0);
+		scheduler.push_next(MakeCommand("next 2"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0);
+		CheckPopOrder("push_next goes first, latest first", scheduler, 1000, 3, "next 2,next,protection");
+	}
+}
+
+// the secondary link only carries some classes, see pop()
+void SchedulerMaskTests()
+{
+	printf("scheduler masks\n");
+	PaceBmsScheduler scheduler;
+	scheduler.push(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 1000);
+	scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+	scheduler.push_next(MakeCommand("write"), PaceBmsScheduler::PRIORITY_WRITE, 0);
+	CheckPopOrder("only the classes in the mask", scheduler, 0, 2, "protection,none", PROTECTION_ONLY);
+	CheckPopOrder("the rest on the other bus", scheduler, 0, 3, "write,configuration,none");
+}
+
+void SchedulerWriteBurstTests()
+{
+	printf("scheduler write bursts\n");
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.set_max_consecutive_writes(2);
+		for (const char* write : { "write 1", "write 2", "write 3" })
+			scheduler.push(MakeCommand(write), PaceBmsScheduler::PRIORITY_WRITE, 0, 100);
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+		CheckPopOrder("a read gets a turn after a burst", scheduler, 0, 4, "write 1,write 2,protection,write 3");
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.set_max_consecutive_writes(2);
+		for (const char* write : { "write 1", "write 2", "write 3" })
+			scheduler.push(MakeCommand(write), PaceBmsScheduler::PRIORITY_WRITE, 0, 100);
+		CheckPopOrder("writes keep going with no reads waiting", scheduler, 0, 3, "write 1,write 2,write 3");
+	}
+	{
+		// a read on a bus that doesn't carry writes doesn't count as the reads' turn
+		PaceBmsScheduler scheduler;
+		scheduler.set_max_consecutive_writes(2);
+		for (const char* write : { "write 1", "write 2", "write 3" })
+			scheduler.push(MakeCommand(write), PaceBmsScheduler::PRIORITY_WRITE, 0, 100);
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 5000);
+		scheduler.push(MakeCommand("protection 2"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 6000);
+		CheckPopOrder("burst", scheduler, 0, 2, "write 1,write 2");
+		CheckPopOrder("read on the other bus", scheduler, 0, 1, "protection", PROTECTION_ONLY);
+		CheckPopOrder("still the reads' turn", scheduler, 0, 2, "protection 2,write 3");
+	}
+}
+
+void SchedulerBookkeepingTests()
+{
+	printf("scheduler bookkeeping\n");
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("protection"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1000);
+		scheduler.push(MakeCommand("write"), PaceBmsScheduler::PRIORITY_WRITE, 0, 1000);
+		scheduler.push_next(MakeCommand("configuration"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0);
+		scheduler.push_next(MakeCommand("write 2"), PaceBmsScheduler::PRIORITY_WRITE, 0);
+		printf("  drop_reads\n");
+		CheckEqual("dropped", scheduler.drop_reads(), 2);
+		CheckEqual("writes left", scheduler.get_write_count(), 2);
+		CheckEqual("reads left", scheduler.get_read_count(), 0);
+		CheckPopOrder("drop_reads keeps the writes", scheduler, 0, 3, "write 2,write,none");
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("write"), PaceBmsScheduler::PRIORITY_WRITE, 0, 1000);
+		PaceBmsScheduler::command_item* replacement = MakeCommand("write");
+		replacement->attempts_ = 7;
+		scheduler.push_with_deduplication(replacement, PaceBmsScheduler::PRIORITY_WRITE, 500, 1000);
+		printf("  push_with_deduplication\n");
+		CheckEqual("one copy", scheduler.size(), 1);
+		PaceBmsScheduler::command_item* item = scheduler.pop(0);
+		CheckEqual("replaced content", item->attempts_, 7);
+		CheckEqual("kept its deadline", item->deadline_, 1000);
+		delete item;
+	}
+	{
+		PaceBmsScheduler scheduler;
+		scheduler.push(MakeCommand("late"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1000);
+		scheduler.push(MakeCommand("later"), PaceBmsScheduler::PRIORITY_PROTECTION, 0, 1000);
+		scheduler.push(MakeCommand("on time"), PaceBmsScheduler::PRIORITY_CONFIGURATION, 0, 5000);
+		// push_next items can't be late whenever they go
+		scheduler.push_next(MakeCommand("next"), PaceBmsScheduler::PRIORITY_WRITE, 0);
+		PopOrder(scheduler, 1500, 2);
+		PopOrder(scheduler, 1800, 2);
+		printf("  statistics\n");
+		const PaceBmsScheduler::Statistics& protection = scheduler.get_statistics(PaceBmsScheduler::PRIORITY_PROTECTION);
+		CheckEqual("protection granted", protection.granted, 2);
+		CheckEqual("protection missed", protection.missed, 2);
+		CheckEqual("protection worst lateness", protection.worst_lateness, 800);
+		CheckEqual("configuration granted", scheduler.get_statistics(PaceBmsScheduler::PRIORITY_CONFIGURATION).granted, 1);
+		CheckEqual("write missed", scheduler.get_statistics(PaceBmsScheduler::PRIORITY_WRITE).missed, 0);
+		CheckEqual("missed", scheduler.get_missed_count(), 2);
+	}
+}
+
+std::vector<uint8_t> Frame(const char* text)
+{
+	return std::vector<uint8_t>(text, text + strlen(text));
+}
+
+// what's returned for a request, as text, or "none" if nothing is
+std::string Lookup(const PaceBmsProxyCache& cache, const std::vector<uint8_t>& request, uint32_t now, uint32_t ttl)
+{
+	const std::vector<uint8_t>* response = cache.lookup(request.data(), request.size(), now, ttl);
+	return response == nullptr ? std::string("none") : std::string(response->begin(), response->end());
+}
+
+void CheckLookup(const char* what, const PaceBmsProxyCache& cache, const std::vector<uint8_t>& request, uint32_t now, uint32_t ttl, const char* expected)
+{
+	printf("  %s\n", what);
+	CheckText(what, Lookup(cache, request, now, ttl), expected);
+}
+
+void ProxyCacheTests()
+{
+	printf("proxy cache\n");
+	std::vector<uint8_t> analog = Frame("~25014642E00201FD30\r");
+	std::vector<uint8_t> status = Frame("~25014644E00201FD2E\r");
+	std::vector<uint8_t> other_address = Frame("~25024642E00202FD2E\r");
+	std::vector<uint8_t> first = Frame("first");
+	std::vector<uint8_t> second = Frame("second");
+	PaceBmsProxyCache cache;
+
+	CheckLookup("empty", cache, analog, 0, 10000, "none");
+
+	// a client's own request (a write, or a read the hub doesn't make) doesn't get an entry
+	cache.store(status, first.data(), first.size(), false, 1000);
+	CheckLookup("not added", cache, status, 1000, 10000, "none");
+
+	cache.store(analog, first.data(), first.size(), true, 1000);
+	CheckLookup("added", cache, analog, 1000, 10000, "first");
+	CheckLookup("within ttl", cache, analog, 10999, 10000, "first");
+	CheckLookup("expired", cache, analog, 11000, 10000, "none");
+	CheckLookup("same command, other address", cache, other_address, 1000, 10000, "none");
+
+	// a client's request for an expired entry is forwarded, and its response refreshes the entry
+	cache.store(analog, second.data(), second.size(), false, 12000);
+	CheckLookup("refreshed", cache, analog, 12000, 10000, "second");
+	CheckEqual("entries", cache.size(), 1);
+
+	// millis() rolled over since the response was stored
+	cache.store(status, first.data(), first.size(), true, 0xFFFFF000);
+	CheckLookup("across rollover", cache, status, 0x00000100, 10000, "first");
+}
+
+}  // namespace
+
+int main()
+{
+	EnergyIntegrationTests();
+	SchedulerContainsTests();
+	SchedulerOrderTests();
+	SchedulerMaskTests();
+	SchedulerWriteBurstTests();
+	SchedulerBookkeepingTests();
+	ProxyCacheTests();
+	if (failures == 0)
+		printf("all checks passed\n");
+	return failures;
+}
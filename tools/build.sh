@@ -0,0 +1,17 @@
+#!/bin/sh
+# Builds the offline capture replay tool, see replay_capture.cpp.
+#
+#   tools/build.sh
+#   curl -o capture.pcap http://<device>/pace_bms/capture.pcap
+#   tools/out/replay_capture capture.pcap
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../components/pace_bms"
+OUT="${OUT:-$HERE/out}"
+
+mkdir -p "$OUT"
+${CXX:-c++} -std=c++17 -O2 -I"$SRC" -DPACE_BMS_USE_STD_OPTIONAL \
+	"$HERE/replay_capture.cpp" "$SRC/pace_bms_frame_capture.cpp" \
+	"$SRC/pace_bms_protocol_base.cpp" "$SRC/pace_bms_protocol_v20.cpp" "$SRC/pace_bms_protocol_v25.cpp" \
+	-o "$OUT/replay_capture"
@@ -0,0 +1,354 @@
+/*
+* Replays a pace_bms frame capture through the protocol parsers, offline.
+*
+* Reads either the pcap file served at frame_capture's web_path, or log output from PaceBms::dump_frame_capture()
+* (the "capture <micros> <type> <frame>" lines, any logger prefix in front of them is ignored).
+*
+* For every request/response pair it prints the bus timing from the capture (request to response, and the idle gap
+* before the next request) and how long the matching Process*Response call takes on this machine.  A summary per
+* command follows.  The parse timings are of course for the host CPU, compare them relative to each other.
+*
+*   tools/replay_capture [--variant PYLON|SEPLOS|EG4] [--iterations N] [--quiet] CAPTURE
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pace_bms_frame_capture.h"
+#include "pace_bms_protocol_v20.h"
+#include "pace_bms_protocol_v25.h"
+
+using esphome::pace_bms::PaceBmsFrameCapture;
+
+namespace {
+
+void LogNothing(PaceBmsProtocolBase::LogLevel, const char*, va_list) {}
+
+struct Record
+{
+	uint8_t type;
+	uint64_t timestamp;
+	std::vector<uint8_t> data;
+};
+
+uint32_t ReadU32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+bool ParsePcap(const std::vector<uint8_t>& file, std::vector<Record>& records)
+{
+	if (file.size() < 24 || ReadU32(file.data()) != 0xA1B2C3D4)
+		return false;
+	if (ReadU32(file.data() + 20) != PaceBmsFrameCapture::PCAP_LINKTYPE_USER0)
+		fprintf(stderr, "warning: unexpected pcap link type, decoding anyway\n");
+
+	size_t offset = 24;
+	while (offset + 16 <= file.size())
+	{
+		uint64_t timestamp = (uint64_t)ReadU32(&file[offset]) * 1000000 + ReadU32(&file[offset + 4]);
+		uint32_t length = ReadU32(&file[offset + 8]);
+		offset += 16;
+		if (length == 0 || offset + length > file.size())
+			break;
+		Record record;
+		record.type = file[offset];
+		record.timestamp = timestamp;
+		record.data.assign(file.begin() + offset + 1, file.begin() + offset + length);
+		records.push_back(record);
+		offset += length;
+	}
+	return true;
+}
+
+bool ParseText(const std::vector<uint8_t>& file, std::vector<Record>& records)
+{
+	std::istringstream stream(std::string(file.begin(), file.end()));
+	std::string line;
+	bool first = true;
+	uint32_t previous = 0;
+	uint64_t elapsed = 0;
+	while (std::getline(stream, line))
+	{
+		size_t at = line.find("capture ");
+		if (at == std::string::npos)
+			continue;
+		std::istringstream fields(line.substr(at + 8));
+		unsigned long micros;
+		char type;
+		std::string frame;
+		if (!(fields >> micros >> type))
+			continue;
+		fields >> frame;
+
+		Record record;
+		record.type = (uint8_t)type;
+		if (type == PaceBmsFrameCapture::RECORD_ABANDONED)
+		{
+			// written as hex since it can contain anything
+			for (size_t i = 0; i + 1 < frame.size(); i += 2)
+				record.data.push_back((uint8_t)std::stoi(frame.substr(i, 2), nullptr, 16));
+		}
+		else
+		{
+			record.data.assign(frame.begin(), frame.end());
+			record.data.push_back('\r');
+		}
+
+		// the log has raw micros(), rebuild a monotonic timeline across wraps the same way the pcap export does
+		if (!first)
+			elapsed += (uint32_t)((uint32_t)micros - previous);
+		first = false;
+		previous = (uint32_t)micros;
+		record.timestamp = elapsed;
+		records.push_back(record);
+	}
+	return !records.empty();
+}
+
+uint8_t HexByte(const std::vector<uint8_t>& frame, size_t offset)
+{
+	if (offset + 2 > frame.size())
+		return 0;
+	return (uint8_t)std::stoi(std::string(frame.begin() + offset, frame.begin() + offset + 2), nullptr, 16);
+}
+
+struct Replayer
+{
+	OPTIONAL_NS::optional<std::string> variant;
+	int iterations{ 100 };
+
+	// returns false if there's no parser for this command
+	bool Parse(const std::vector<uint8_t>& request, const std::vector<uint8_t>& response, const char*& name, bool& ok)
+	{
+		uint8_t version = HexByte(request, 1);
+		uint8_t busId = HexByte(request, 3);
+		uint8_t cid1 = HexByte(request, 5);
+		uint8_t cid2 = HexByte(request, 7);
+		uint8_t command = HexByte(request, 13);
+
+		if (version == 0x25)
+		{
+			PaceBmsProtocolV25 protocol({}, {}, cid1, LogNothing);
+			return ParseV25(protocol, cid2, command, busId, response, name, ok);
+		}
+		if (version == 0x20)
+		{
+			PaceBmsProtocolV20 protocol(variant, {}, cid1, LogNothing);
+			return ParseV20(protocol, cid2, busId, response, name, ok);
+		}
+		return false;
+	}
+
+	template <typename Configuration>
+	static bool ReadConfiguration(PaceBmsProtocolV25& p, uint8_t busId, const std::vector<uint8_t>& response)
+	{
+		Configuration config;
+		return p.ProcessReadConfigurationResponse(busId, response, config);
+	}
+
+	bool ParseV25(PaceBmsProtocolV25& p, uint8_t cid2, uint8_t command, uint8_t busId, const std::vector<uint8_t>& r, const char*& name, bool& ok)
+	{
+		// the CID2 values are protected in the protocol classes, these match PaceBmsProtocolV25::CID2
+		switch (cid2)
+		{
+		case 0x42: name = "v25 read analog information"; ok = Time([&] { PaceBmsProtocolV25::AnalogInformation a; return p.ProcessReadAnalogInformationResponse(busId, r, a); }); return true;
+		case 0x44: name = "v25 read status information"; ok = Time([&] { PaceBmsProtocolV25::StatusInformation s; return p.ProcessReadStatusInformationResponse(busId, r, s); }); return true;
+		case 0xC1: name = "v25 read hardware version"; ok = Time([&] { std::string s; return p.ProcessReadHardwareVersionResponse(busId, r, s); }); return true;
+		case 0xC2: name = "v25 read serial number"; ok = Time([&] { std::string s; return p.ProcessReadSerialNumberResponse(busId, r, s); }); return true;
+		case 0x99: name = "v25 write switch command"; ok = Time([&] { return p.ProcessWriteSwitchCommandResponse(busId, (PaceBmsProtocolV25::SwitchCommand)command, r); }); return true;
+		case 0x9A:
+		case 0x9B: name = "v25 write mosfet switch command"; ok = Time([&] { return p.ProcessWriteMosfetSwitchCommandResponse(busId, (PaceBmsProtocolV25::MosfetType)cid2, (PaceBmsProtocolV25::MosfetState)command, r); }); return true;
+		case 0x9C: name = "v25 write shutdown"; ok = Time([&] { return p.ProcessWriteShutdownCommandResponse(busId, r); }); return true;
+		case 0xB1: name = "v25 read system date/time"; ok = Time([&] { PaceBmsProtocolV25::DateTime d; return p.ProcessReadSystemDateTimeResponse(busId, r, d); }); return true;
+		case 0xB2: name = "v25 write system date/time"; ok = Time([&] { return p.ProcessWriteSystemDateTimeResponse(busId, r); }); return true;
+		case 0xD1: name = "v25 read cell over voltage configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::CellOverVoltageConfiguration>(p, busId, r); }); return true;
+		case 0xD5: name = "v25 read pack over voltage configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::PackOverVoltageConfiguration>(p, busId, r); }); return true;
+		case 0xD3: name = "v25 read cell under voltage configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::CellUnderVoltageConfiguration>(p, busId, r); }); return true;
+		case 0xD7: name = "v25 read pack under voltage configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::PackUnderVoltageConfiguration>(p, busId, r); }); return true;
+		case 0xD9: name = "v25 read charge over current configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::ChargeOverCurrentConfiguration>(p, busId, r); }); return true;
+		case 0xDB: name = "v25 read discharge over current 1 configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::DischargeOverCurrent1Configuration>(p, busId, r); }); return true;
+		case 0xE3: name = "v25 read discharge over current 2 configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::DischargeOverCurrent2Configuration>(p, busId, r); }); return true;
+		case 0xE5: name = "v25 read short circuit protection configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::ShortCircuitProtectionConfiguration>(p, busId, r); }); return true;
+		case 0xB6: name = "v25 read cell balancing configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::CellBalancingConfiguration>(p, busId, r); }); return true;
+		case 0xA0: name = "v25 read sleep configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::SleepConfiguration>(p, busId, r); }); return true;
+		case 0xAF: name = "v25 read full charge low charge configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::FullChargeLowChargeConfiguration>(p, busId, r); }); return true;
+		case 0xDD: name = "v25 read charge and discharge over temperature configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::ChargeAndDischargeOverTemperatureConfiguration>(p, busId, r); }); return true;
+		case 0xDF: name = "v25 read charge and discharge under temperature configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::ChargeAndDischargeUnderTemperatureConfiguration>(p, busId, r); }); return true;
+		case 0xE1: name = "v25 read mosfet over temperature configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::MosfetOverTemperatureConfiguration>(p, busId, r); }); return true;
+		case 0xE7: name = "v25 read environment over/under temperature configuration"; ok = Time([&] { return ReadConfiguration<PaceBmsProtocolV25::EnvironmentOverUnderTemperatureConfiguration>(p, busId, r); }); return true;
+		case 0xD0: case 0xD4: case 0xD2: case 0xD6: case 0xD8: case 0xDA: case 0xE2: case 0xE4:
+		case 0xB5: case 0xA8: case 0xAE: case 0xDC: case 0xDE: case 0xE0: case 0xE6:
+			name = "v25 write configuration"; ok = Time([&] { return p.ProcessWriteConfigurationResponse(busId, r); }); return true;
+		case 0xED: name = "v25 read charge current limiter start current"; ok = Time([&] { uint8_t c; return p.ProcessReadChargeCurrentLimiterStartCurrentResponse(busId, r, c); }); return true;
+		case 0xEE: name = "v25 write charge current limiter start current"; ok = Time([&] { return p.ProcessWriteChargeCurrentLimiterStartCurrentResponse(busId, r); }); return true;
+		case 0xA6: name = "v25 read remaining capacity"; ok = Time([&] { uint32_t remaining, actual, design; return p.ProcessReadRemainingCapacityResponse(busId, r, remaining, actual, design); }); return true;
+		case 0xEB: name = "v25 read protocols"; ok = Time([&] { PaceBmsProtocolV25::Protocols protocols; return p.ProcessReadProtocolsResponse(busId, r, protocols); }); return true;
+		case 0xEC: name = "v25 write protocols"; ok = Time([&] { return p.ProcessWriteProtocolsResponse(busId, r); }); return true;
+		}
+		return false;
+	}
+
+	bool ParseV20(PaceBmsProtocolV20& p, uint8_t cid2, uint8_t busId, const std::vector<uint8_t>& r, const char*& name, bool& ok)
+	{
+		// these match PaceBmsProtocolV20::CID2
+		switch (cid2)
+		{
+		case 0x42: name = "v20 read analog information"; ok = Time([&] { PaceBmsProtocolV20::AnalogInformation a; return p.ProcessReadAnalogInformationResponse(busId, r, a); }); return true;
+		case 0x44: name = "v20 read status information"; ok = Time([&] { PaceBmsProtocolV20::StatusInformation s; return p.ProcessReadStatusInformationResponse(busId, r, s); }); return true;
+		case 0x51: name = "v20 read hardware version"; ok = Time([&] { std::string s; return p.ProcessReadHardwareVersionResponse(busId, r, s); }); return true;
+		case 0x93: name = "v20 read serial number"; ok = Time([&] { std::string s; return p.ProcessReadSerialNumberResponse(busId, r, s); }); return true;
+		case 0x95: name = "v20 write shutdown"; ok = Time([&] { return p.ProcessWriteShutdownCommandResponse(busId, r); }); return true;
+		case 0x4D: name = "v20 read system date/time"; ok = Time([&] { PaceBmsProtocolV20::DateTime d; return p.ProcessReadSystemDateTimeResponse(busId, r, d); }); return true;
+		case 0x4E: name = "v20 write system date/time"; ok = Time([&] { return p.ProcessWriteSystemDateTimeResponse(busId, r); }); return true;
+		}
+		return false;
+	}
+
+	// nanoseconds per call for the last Time()
+	double lastParseNanoseconds{ 0 };
+
+	template <typename Call>
+	bool Time(Call call)
+	{
+		bool result = call();
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+			call();
+		lastParseNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+		return result;
+	}
+};
+
+struct Stats
+{
+	uint32_t count{ 0 };
+	uint32_t failed{ 0 };
+	uint32_t abandoned{ 0 };
+	uint64_t latencyTotal{ 0 };
+	uint64_t latencyMax{ 0 };
+	double parseTotal{ 0 };
+	double parseMax{ 0 };
+};
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+	Replayer replayer;
+	bool quiet = false;
+	const char* path = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--variant") == 0 && i + 1 < argc)
+			replayer.variant = std::string(argv[++i]);
+		else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			replayer.iterations = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--quiet") == 0)
+			quiet = true;
+		else
+			path = argv[i];
+	}
+	if (path == nullptr)
+	{
+		fprintf(stderr, "usage: %s [--variant PYLON|SEPLOS|EG4] [--iterations N] [--quiet] CAPTURE\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+	{
+		fprintf(stderr, "Unable to read %s\n", path);
+		return 1;
+	}
+	std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	std::vector<Record> records;
+	if (!ParsePcap(file, records) && !ParseText(file, records))
+	{
+		fprintf(stderr, "%s is neither a pcap capture nor a capture log\n", path);
+		return 1;
+	}
+
+	std::map<std::string, Stats> stats;
+	uint64_t busBusy = 0;
+	uint32_t orphans = 0;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const Record& request = records[i];
+		if (request.type != PaceBmsFrameCapture::RECORD_REQUEST)
+		{
+			// a response with no request in front of it, most likely the request fell off the front of the ring buffer
+			orphans++;
+			continue;
+		}
+
+		// the request is always followed by its response or by whatever was received before giving up
+		const Record* response = nullptr;
+		if (i + 1 < records.size() && records[i + 1].type != PaceBmsFrameCapture::RECORD_REQUEST)
+			response = &records[++i];
+		const Record* next = i + 1 < records.size() ? &records[i + 1] : nullptr;
+
+		const char* name = "unknown command";
+		bool ok = false;
+		bool known = false;
+		if (response != nullptr && response->type == PaceBmsFrameCapture::RECORD_RESPONSE)
+			known = replayer.Parse(request.data, response->data, name, ok);
+		else
+			replayer.Parse(request.data, std::vector<uint8_t>(), name, ok);
+
+		Stats& s = stats[name];
+		s.count++;
+		uint64_t latency = response != nullptr ? response->timestamp - request.timestamp : 0;
+		uint64_t gap = next != nullptr && response != nullptr ? next->timestamp - response->timestamp : 0;
+		busBusy += latency;
+		if (response == nullptr || response->type != PaceBmsFrameCapture::RECORD_RESPONSE)
+		{
+			s.abandoned++;
+		}
+		else
+		{
+			if (!ok)
+				s.failed++;
+			s.latencyTotal += latency;
+			s.latencyMax = std::max(s.latencyMax, latency);
+			if (known)
+			{
+				s.parseTotal += replayer.lastParseNanoseconds;
+				s.parseMax = std::max(s.parseMax, replayer.lastParseNanoseconds);
+			}
+		}
+
+		if (!quiet)
+		{
+			const char* result = response == nullptr ? "no response" :
+				response->type != PaceBmsFrameCapture::RECORD_RESPONSE ? "abandoned" :
+				!known ? "not parsed" : ok ? "ok" : "parse failed";
+			printf("%12.6f  %-60s %-12s response %7.1f ms  idle %7.1f ms  parse %8.0f ns\n",
+				request.timestamp / 1e6, name, result, latency / 1e3, gap / 1e3, known ? replayer.lastParseNanoseconds : 0.0);
+		}
+	}
+
+	uint64_t span = records.size() > 1 ? records.back().timestamp - records.front().timestamp : 0;
+	printf("\n%-60s %6s %6s %9s %12s %12s %12s %12s\n", "command", "count", "failed", "abandoned", "avg resp ms", "max resp ms", "avg parse ns", "max parse ns");
+	for (const auto& entry : stats)
+	{
+		const Stats& s = entry.second;
+		uint32_t answered = s.count - s.abandoned;
+		printf("%-60s %6u %6u %9u %12.1f %12.1f %12.0f %12.0f\n", entry.first.c_str(), s.count, s.failed, s.abandoned,
+			answered > 0 ? s.latencyTotal / 1e3 / answered : 0.0, s.latencyMax / 1e3,
+			answered > 0 ? s.parseTotal / answered : 0.0, s.parseMax);
+	}
+	printf("\n%zu records over %.1f s, bus busy waiting on responses %.1f%% of the time", records.size(), span / 1e6, span > 0 ? 100.0 * busBusy / span : 0.0);
+	if (orphans > 0)
+		printf(", %u responses without a request", orphans);
+	printf("\n");
+	return 0;
+}